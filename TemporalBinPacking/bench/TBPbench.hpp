@@ -0,0 +1,63 @@
+//
+// Created by lhirwashema on 2022-08-07.
+//
+// Helpers shared by the benchmarks of this folder: timing, peak RSS, option lists and runs in a child process.
+//
+
+#pragma once
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+inline double elapsedMs(chrono::steady_clock::time_point start){
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Largest resident set of the process so far, in kB
+ */
+inline long getPeakRssKb(){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * Integers of a comma-separated list, as given to --sizes
+ */
+inline vector<int> parseSizes(const string & list){
+    vector<int> sizes;
+    stringstream in(list);
+    string token;
+    while (getline(in, token, ','))
+        sizes.push_back(atoi(token.c_str()));
+    return sizes;
+}
+
+/**
+ * Runs a measure in a child process, so that the peak RSS it reports is its own and not the largest one
+ * of the runs before it. What the child prints goes out before this returns.
+ * Returns false if the child crashed or exited with an error
+ */
+inline bool runInChild(const function<void()> & run){
+    cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        run();
+        cout.flush();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
@@ -0,0 +1,77 @@
+//
+// Created by lhirwashema on 2022-07-04.
+//
+// Compares the bitset enumeration of feasible combinations with the former recursive one
+// on data/I_1.txt and on generated instances with wider cliques.
+//
+
+#include "../include/TBPdata.hpp"
+#include "../include/TBPgenerator.hpp"
+#include "TBPbench.hpp"
+#include <iomanip>
+#include <string>
+
+using namespace std;
+
+/**
+ * Enumerates the combinations of every maximum clique with both methods and prints one line of results
+ */
+static void benchInstance(const string & name, TemporalBPData & data, int nbRuns){
+    vector<vector<int>> cliques = data.getMaxCliques();
+    int maxWidth = 0;
+    for (const auto & clique : cliques)
+        maxWidth = max(maxWidth, (int)clique.size());
+
+    long nbCombos = 0;
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < nbRuns; r++)
+        for (const auto & clique : cliques)
+            nbCombos += data.getFeasibleCombinationsRecursive(clique).size();
+    double recursiveMs = elapsedMs(start) / nbRuns;
+
+    long nbBitsetCombos = 0;
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < nbRuns; r++)
+        for (const auto & clique : cliques)
+            nbBitsetCombos += data.getFeasibleCombos(clique).size();
+    double bitsetMs = elapsedMs(start) / nbRuns;
+
+    bool same = (nbCombos == nbBitsetCombos);
+    for (const auto & clique : cliques)
+        same = same && (data.getFeasibleCombinationsRecursive(clique) == data.getFeasibleCombinations(clique));
+
+    cout << setw(12) << left << name
+         << " items=" << setw(7) << data.getNbItems()
+         << " cliques=" << setw(6) << cliques.size()
+         << " maxWidth=" << setw(4) << maxWidth
+         << " combos=" << setw(10) << nbCombos / nbRuns
+         << " recursive=" << fixed << setprecision(3) << recursiveMs << "ms"
+         << " bitset=" << bitsetMs << "ms"
+         << " speedup=" << setprecision(1) << (bitsetMs > 0 ? recursiveMs / bitsetMs : 0.0)
+         << (same ? "" : " MISMATCH") << endl;
+}
+
+int main(int argc, char * argv[]){
+    string fileName = argc > 1 ? argv[1] : "../data/I_1.txt";
+    ifstream dataFile(fileName);
+    if (dataFile) {
+        TemporalBPData data(dataFile, false);
+        benchInstance("I_1", data, 100);
+    } else {
+        cout << "<benchCombos> Could not read " << fileName << endl;
+    }
+
+    int sizes[] = {200, 1000, 5000};
+    for (const auto & nbItems : sizes) {
+        GeneratorParams params;
+        params._nbItems = nbItems;
+        params._capacity = 100;
+        params._minSize = 5;
+        params._maxSize = 40;
+        params._horizon = nbItems * 4;
+        params._minLength = 40;
+        params._maxLength = 80;
+        TemporalBPData data(params._capacity, generateItems(params, 1));
+        benchInstance("gen_" + to_string(nbItems), data, 1);
+    }
+}
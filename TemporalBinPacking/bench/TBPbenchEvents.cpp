@@ -0,0 +1,138 @@
+//
+// Created by lhirwashema on 2022-08-06.
+//
+// Builds the normal, the reduced and the event graph (TBPevents.hpp) of generated instances side by side.
+// One line per graph gives its build time, its size (columns, vertices, arcs, largest column, bytes of its arrays),
+// the bins of the greedy decomposition with the lower bound of its columns, and the peak RSS.
+// Each graph is built in a child process of its own (runInChild).
+// With --check n, n small instances with items of length 0 among them are solved instead on the normal and the event
+// graph, which have to reach the same optimum whenever both prove it.
+//
+// Usage: TBPbenchEvents [--sizes 500,2000,...] [--overlap x] [--min-size a] [--max-size b] [--check n]
+//
+
+#include "../include/TBPdata.hpp"
+#include "../include/TBPevents.hpp"
+#include "../include/TBPgenerator.hpp"
+#include "../include/TBPsolver.hpp"
+#include "TBPbench.hpp"
+#include <iomanip>
+
+using namespace std;
+
+static const char * METHOD_NAMES[] = {"normal", "reduced", "events"};
+
+static void run(TemporalBPData & data, int method){
+    auto start = chrono::steady_clock::now();
+    if (method == 0)
+        data._graph = data.buildGraph();
+    else if (method == 1)
+        data._graph = data.buildReducedGraph();
+    else
+        data._graph = buildEventGraph(data);
+    const double graphMs = elapsedMs(start);
+    const LayeredGraph & graph = data._graph;
+    long graphBytes = 0;
+    for (int k = 0; k < NB_GRAPH_ARRAYS; k++)
+        graphBytes += graph.getArray(GraphArray(k)).size() * sizeof(int);
+
+    start = chrono::steady_clock::now();
+    TBPSolver solver(data);
+    const TBPSolution greedy = solver.solveGreedy();
+    const int lowerBound = solver.computeLowerBound();
+    const double greedyMs = elapsedMs(start);
+
+    cout << setw(8) << left << METHOD_NAMES[method]
+         << " items=" << setw(6) << data.getNbItems()
+         << " columns=" << setw(7) << graph.getNbColumns()
+         << " vertices=" << setw(9) << graph.getNbVertices()
+         << " arcs=" << setw(10) << graph.getNbArcs()
+         << " maxColumn=" << setw(7) << data.getMaxNbCombosClique()
+         << " graphKB=" << setw(8) << (graphBytes >> 10)
+         << " bins=" << setw(4) << greedy._nbBins
+         << " lowerBound=" << setw(4) << lowerBound
+         << fixed << setprecision(1)
+         << " graph=" << graphMs << "ms"
+         << " greedy=" << greedyMs << "ms"
+         << " peakRss=" << getPeakRssKb() << "KB" << endl;
+}
+
+/**
+ * Solves n small instances, one item of five leaving as soon as it enters and entries sharing dates,
+ * on both graphs. Returns the number of instances whose proven optima differ or whose solution is not valid
+ */
+static int checkOptima(int n){
+    int nbFailures = 0;
+    int nbCompared = 0;
+    for (int seed = 1; seed <= n; seed++) {
+        GeneratorParams params;
+        params._nbItems = 8 + seed % 25;
+        params._capacity = 10;
+        params._minSize = 1;
+        params._maxSize = 6;
+        params._horizon = 10 + seed % 10;
+        params._minLength = 1;
+        params._maxLength = 6;
+        vector<Item> items = generateItems(params, seed);
+        for (int i = 0; i < (int)items.size(); i += 5)
+            items[i]._exit = items[i]._entry;
+
+        TemporalBPData normal(params._capacity, items);
+        TemporalBPData events(params._capacity, items);
+        normal._graph = normal.buildGraph();
+        events._graph = buildEventGraph(events);
+        const TBPSolution normalSolution = TBPSolver(normal).solve();
+        const TBPSolution eventSolution = TBPSolver(events).solve();
+        bool failed = !isValidSolution(events, eventSolution);
+        if (normalSolution._optimal && eventSolution._optimal) {
+            nbCompared++;
+            failed = failed || normalSolution._nbBins != eventSolution._nbBins;
+        }
+        if (failed) {
+            nbFailures++;
+            cerr << "<benchEvents> Seed " << seed << ": normal " << normalSolution._nbBins << " bins (optimal " << normalSolution._optimal
+                 << "), events " << eventSolution._nbBins << " bins (optimal " << eventSolution._optimal << ")" << endl;
+        }
+    }
+    cout << "check instances=" << n << " compared=" << nbCompared << " failures=" << nbFailures << endl;
+    return nbFailures;
+}
+
+int main(int argc, char * argv[]){
+    vector<int> sizes = {500, 1000, 2000};
+    int nbChecks = 0;
+    GeneratorParams params;
+    params._capacity = 100;
+    params._minSize = 5;
+    params._maxSize = 40;
+    params._minLength = 40;
+    params._maxLength = 80;
+    params._overlap = 8;
+    for (int a = 1; a + 1 < argc; a += 2) {
+        const string option = argv[a];
+        if (option == "--sizes") sizes = parseSizes(argv[a + 1]);
+        else if (option == "--overlap") params._overlap = atof(argv[a + 1]);
+        else if (option == "--min-size") params._minSize = atoi(argv[a + 1]);
+        else if (option == "--max-size") params._maxSize = atoi(argv[a + 1]);
+        else if (option == "--check") nbChecks = atoi(argv[a + 1]);
+        else {
+            cerr << "<benchEvents> Invalid option " << option << endl;
+            return 1;
+        }
+    }
+
+    if (nbChecks > 0)
+        return checkOptima(nbChecks) == 0 ? 0 : 1;
+
+    for (const auto & nbItems : sizes) {
+        params._nbItems = nbItems;
+        for (int method = 0; method < 3; method++) {
+            const bool ok = runInChild([&](){
+                TemporalBPData data(params._capacity, generateItems(params, 1));
+                run(data, method);
+            });
+            if (!ok)
+                cerr << "<benchEvents> Run of the " << METHOD_NAMES[method] << " graph with " << nbItems << " items failed" << endl;
+        }
+    }
+}
@@ -0,0 +1,150 @@
+//
+// Created by lhirwashema on 2022-08-05.
+//
+// Writes the graph of generated instances in the formats of TBPexport.hpp and compares them with the listing
+// the executable used to print (strings concatenated per vertex, one endl per line), the build time being the
+// reference. The DIMACS file is also written while the graph is streamed from the instance file, without
+// assembling it, and checked to be the same as the one of the built graph.
+// One line per instance gives the time and the throughput of every writer.
+//
+// Usage: TBPbenchExport [--sizes 1000,5000,...] [--folder f] [--reduced 0|1] [--keep 0|1]
+//
+
+#include "../include/TBPdata.hpp"
+#include "../include/TBPexport.hpp"
+#include "../include/TBPgenerator.hpp"
+#include "../include/TBPstream.hpp"
+#include "TBPbench.hpp"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <iomanip>
+#include <string>
+
+using namespace std;
+
+static long getFileSize(const string & fileName){
+    struct stat status;
+    return stat(fileName.c_str(), &status) == 0 ? status.st_size : -1;
+}
+
+static bool haveSameContent(const string & first, const string & second){
+    ifstream a(first, ios::binary);
+    ifstream b(second, ios::binary);
+    return a && b && string(istreambuf_iterator<char>(a), istreambuf_iterator<char>())
+                  == string(istreambuf_iterator<char>(b), istreambuf_iterator<char>());
+}
+
+/**
+ * Listing of the graph as the executable printed it before TBPexport.hpp
+ */
+static void writeListing(const LayeredGraph & graph, const string & fileName){
+    ofstream out(fileName);
+    for (int v = 0; v < graph.getNbVertices(); v++) {
+        VertexView u = graph.getVertexById(v);
+        const vector<int> items = u.getItems();
+        string sItems = "(";
+        for (int i = 0; i < (int)items.size(); i++) {
+            sItems += to_string(items[i]);
+            if (i < (int)items.size() - 1) sItems += ",";
+        }
+        sItems += ")";
+        string sArcs = "{";
+        for (int i = 0; i < u.getNbArcs(); i++) {
+            ArcView arc = u.getArc(i);
+            sArcs += to_string(arc.getSuccessorId());
+            sArcs += arc.getNbNewItems() == 0 ? "-" : "+";
+            if (i < u.getNbArcs() - 1) sArcs += ",";
+        }
+        sArcs += "}";
+        out << "Vertex " << u.getId() << " : \tItems = " << sItems << ",\t Arcs = " << sArcs << endl;
+    }
+}
+
+static void printWriter(const string & name, double ms, long bytes){
+    cout << " " << name << "=" << ms << "ms/" << (bytes >> 20) << "MB/" << (ms > 0 ? (bytes / 1048576.0) / (ms / 1000) : 0) << "MB/s";
+}
+
+int main(int argc, char * argv[]){
+    vector<int> sizes = {1000, 2000, 5000};
+    string folder = "/tmp";
+    bool reduced = false;
+    bool keep = false;
+    for (int a = 1; a + 1 < argc; a += 2) {
+        const string option = argv[a];
+        if (option == "--sizes") sizes = parseSizes(argv[a + 1]);
+        else if (option == "--folder") folder = argv[a + 1];
+        else if (option == "--reduced") reduced = (string(argv[a + 1]) == "1");
+        else if (option == "--keep") keep = (string(argv[a + 1]) == "1");
+        else {
+            cerr << "<benchExport> Invalid option " << option << endl;
+            return 1;
+        }
+    }
+
+    bool allSame = true;
+    for (const auto & nbItems : sizes) {
+        GeneratorParams params;
+        params._nbItems = nbItems;
+        params._capacity = 100;
+        params._minSize = 5;
+        params._maxSize = 40;
+        params._minLength = 40;
+        params._maxLength = 80;
+        params._overlap = 8;
+        const string prefix = folder + "/benchExport_" + to_string(nbItems);
+        TemporalBPData data(params._capacity, generateItems(params, 1));
+        {   ///< in chronological order, as streamGraph needs
+            ofstream out(prefix + ".txt");
+            writeInstance(out, params._capacity, data._items);
+        }
+
+        auto start = chrono::steady_clock::now();
+        data._graph = reduced ? data.buildReducedGraph() : data.buildGraph();
+        const double graphMs = elapsedMs(start);
+
+        start = chrono::steady_clock::now();
+        writeListing(data._graph, prefix + ".listing");
+        const double listingMs = elapsedMs(start);
+
+        string error;
+        start = chrono::steady_clock::now();
+        bool ok = exportGraph(data._graph, prefix + ".min", EXPORT_DIMACS, true, error);
+        const double dimacsMs = elapsedMs(start);
+
+        start = chrono::steady_clock::now();
+        ok = ok && exportGraph(data._graph, prefix + ".tbpe", EXPORT_BINARY, true, error);
+        const double binaryMs = elapsedMs(start);
+
+        ///< build and export together, column after column
+        start = chrono::steady_clock::now();
+        GraphExporter exporter(EXPORT_DIMACS);
+        ok = ok && exporter.open(prefix + "_streamed.min", error);
+        ifstream in(prefix + ".txt");
+        ok = ok && streamGraph(in, reduced, [&](const GraphColumn & column){ exporter.writeColumn(column); });
+        ok = ok && exporter.close(error);
+        const double streamedMs = elapsedMs(start);
+        if (!ok) {
+            cerr << "<benchExport> " << (error.empty() ? "cannot stream " + prefix + ".txt" : error) << endl;
+            return 1;
+        }
+        const bool same = haveSameContent(prefix + ".min", prefix + "_streamed.min");
+        allSame = allSame && same;
+
+        cout << "items=" << setw(6) << left << nbItems
+             << " vertices=" << setw(9) << data._graph.getNbVertices()
+             << " arcs=" << setw(10) << data._graph.getNbArcs()
+             << fixed << setprecision(1)
+             << " graph=" << graphMs << "ms";
+        printWriter("listing", listingMs, getFileSize(prefix + ".listing"));
+        printWriter("dimacs", dimacsMs, getFileSize(prefix + ".min"));
+        printWriter("binary", binaryMs, getFileSize(prefix + ".tbpe"));
+        printWriter("streamed", streamedMs, getFileSize(prefix + "_streamed.min"));
+        cout << " streamedSame=" << same << endl;
+
+        if (!keep)
+            for (const auto & extension : {".txt", ".listing", ".min", ".tbpe", "_streamed.min"})
+                unlink((prefix + extension).c_str());
+    }
+    return allSame ? 0 : 1;
+}
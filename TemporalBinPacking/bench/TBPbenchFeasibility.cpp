@@ -0,0 +1,115 @@
+//
+// Created by lhirwashema on 2022-07-25.
+//
+// Checks random subsets of the widest cliques of generated instances with TemporalBPData::isFeasible,
+// then with FeasibilityKernel one subset at a time and by batches, and prints the times and speedups.
+// Every answer of the kernel is compared with isFeasible.
+//
+// Usage: TBPbenchFeasibility [--masks n] [--cliques n]
+//
+
+#include "../include/TBPdata.hpp"
+#include "../include/TBPfeasibility.hpp"
+#include "../include/TBPgenerator.hpp"
+#include "TBPbench.hpp"
+#include <iomanip>
+#include <random>
+#include <string>
+
+using namespace std;
+
+/**
+ * Draws subsets of about as many items as a bin holds, so that roughly as many fit as do not
+ */
+static vector<uint64_t> drawMasks(const FeasibilityKernel & kernel, int nbMasks, double density, mt19937 & generator){
+    vector<uint64_t> masks((size_t)nbMasks * kernel.getNbWords(), 0);
+    bernoulli_distribution draw(min(1.0, density));
+    for (int m = 0; m < nbMasks; m++)
+        for (int k = 0; k < kernel.getNbItems(); k++)
+            if (draw(generator))
+                masks[(size_t)m * kernel.getNbWords() + (k >> 6)] |= uint64_t(1) << (k & 63);
+    return masks;
+}
+
+static void benchInstance(const string & name, const GeneratorParams & params, int nbMasks, int nbCliques){
+    TemporalBPData data(params._capacity, generateItems(params, 1));
+    vector<vector<int>> cliques = data.getMaxCliques();
+    sort(cliques.begin(), cliques.end(), [](const vector<int> & a, const vector<int> & b){ return a.size() > b.size(); });
+    cliques.resize(min((int)cliques.size(), nbCliques));
+
+    mt19937 generator(1);
+    const double averageSize = (params._minSize + params._maxSize) / 2.0;
+    double isFeasibleMs = 0, scalarMs = 0, batchMs = 0;
+    long nbChecked = 0, nbFeasible = 0, nbMismatches = 0;
+    int maxWidth = 0;
+    for (const auto & clique : cliques) {
+        FeasibilityKernel kernel(data._items, data.getCapacity(), clique);
+        maxWidth = max(maxWidth, kernel.getNbItems());
+        vector<uint64_t> masks = drawMasks(kernel, nbMasks, params._capacity / averageSize / clique.size(), generator);
+        vector<vector<int>> selections(nbMasks);
+        for (int m = 0; m < nbMasks; m++)
+            for (int k = 0; k < kernel.getNbItems(); k++)
+                if ((masks[(size_t)m * kernel.getNbWords() + (k >> 6)] >> (k & 63)) & 1)
+                    selections[m].push_back(kernel.getItems()[k]);
+
+        vector<char> reference(nbMasks), scalar(nbMasks), batch(nbMasks);
+        auto start = chrono::steady_clock::now();
+        for (int m = 0; m < nbMasks; m++)
+            reference[m] = data.isFeasible(selections[m]);
+        isFeasibleMs += elapsedMs(start);
+
+        start = chrono::steady_clock::now();
+        kernel.checkBatchScalar(masks.data(), nbMasks, scalar.data());
+        scalarMs += elapsedMs(start);
+
+        start = chrono::steady_clock::now();
+        nbFeasible += kernel.checkBatch(masks.data(), nbMasks, batch.data());
+        batchMs += elapsedMs(start);
+
+        nbChecked += nbMasks;
+        for (int m = 0; m < nbMasks; m++)
+            nbMismatches += (reference[m] != scalar[m]) + (reference[m] != batch[m]);
+    }
+
+    cout << setw(10) << left << name
+         << " cliques=" << setw(4) << cliques.size()
+         << " maxWidth=" << setw(4) << maxWidth
+         << " masks=" << setw(8) << nbChecked
+         << " feasible=" << setw(8) << nbFeasible
+         << fixed << setprecision(3)
+         << " isFeasible=" << isFeasibleMs << "ms"
+         << " scalar=" << scalarMs << "ms"
+         << " batch=" << batchMs << "ms"
+         << setprecision(1)
+         << " speedup=" << (batchMs > 0 ? isFeasibleMs / batchMs : 0.0)
+         << " simd/scalar=" << (batchMs > 0 ? scalarMs / batchMs : 0.0)
+         << (nbMismatches == 0 ? "" : " MISMATCH") << endl;
+}
+
+int main(int argc, char * argv[]){
+    int nbMasks = 20000;
+    int nbCliques = 20;
+    for (int a = 1; a + 1 < argc; a += 2) {
+        const string option = argv[a];
+        if (option == "--masks") nbMasks = atoi(argv[a + 1]);
+        else if (option == "--cliques") nbCliques = atoi(argv[a + 1]);
+        else {
+            cerr << "<benchFeasibility> Invalid option " << option << endl;
+            return 1;
+        }
+    }
+    cout << "<benchFeasibility> AVX2 " << (FeasibilityKernel::hasSimd() ? "used" : "not available") << endl;
+
+    double overlaps[] = {16, 40, 90};
+    for (const auto & overlap : overlaps) {
+        GeneratorParams params;
+        params._nbItems = 2000;
+        params._capacity = 100;
+        params._minSize = 2;
+        params._maxSize = 12;
+        params._minLength = 40;
+        params._maxLength = 80;
+        params._overlap = overlap;
+        benchInstance("overlap_" + to_string((int)overlap), params, nbMasks, nbCliques);
+    }
+}
@@ -0,0 +1,150 @@
+//
+// Created by lhirwashema on 2022-08-02.
+//
+// Compares the implicit graph of TBPimplicit.hpp with the built graph on generated instances:
+// both run the same greedy dives, which go from the start to the sink by taking at every vertex the arc
+// whose new items have the largest random duals, as a heuristic pricing does. One line per graph gives
+// the time to set it up, the time of the dives, the vertices they expanded and the peak RSS.
+// Each graph is measured in its own child process (runInChild).
+//
+// Usage: TBPbenchImplicit [--sizes 500,2000,...] [--dives n] [--cache n] [--reduced 0|1]
+//
+
+#include "../include/TBPdata.hpp"
+#include "../include/TBPgenerator.hpp"
+#include "../include/TBPimplicit.hpp"
+#include "TBPbench.hpp"
+#include <iomanip>
+#include <random>
+
+using namespace std;
+
+static vector<double> drawDuals(int nbItems, mt19937 & generator){
+    uniform_real_distribution<double> drawDual(0, 1);
+    vector<double> duals(nbItems);
+    for (auto & dual : duals)
+        dual = drawDual(generator);
+    return duals;
+}
+
+static void runImplicit(TemporalBPData & data, bool reduced, int nbDives, size_t cacheSize){
+    auto start = chrono::steady_clock::now();
+    ImplicitGraph graph(data, reduced, cacheSize);
+    const double setupMs = elapsedMs(start);
+
+    mt19937 generator(1);
+    long nbExpanded = 0;
+    start = chrono::steady_clock::now();
+    for (int d = 0; d < nbDives; d++) {
+        const vector<double> duals = drawDuals(data.getNbItems(), generator);
+        ImplicitVertex vertex = graph.getStart();
+        while (!graph.isSink(vertex)) {
+            shared_ptr<const SuccessorList> successors = graph.getSuccessors(vertex);
+            int best = 0;
+            double bestWeight = -1;
+            for (int s = 0; s < successors->size(); s++) {
+                double weight = 0;
+                for (int k = successors->_newItemOffsets[s]; k < successors->_newItemOffsets[s + 1]; k++)
+                    weight += duals[successors->_newItems[k]];
+                if (weight > bestWeight) {
+                    best = s;
+                    bestWeight = weight;
+                }
+            }
+            vertex = successors->getSuccessor(best);
+            nbExpanded++;
+        }
+    }
+    const double divesMs = elapsedMs(start);
+
+    cout << "implicit items=" << setw(6) << left << data.getNbItems()
+         << " cliques=" << setw(6) << graph.getNbCliques()
+         << " expanded=" << setw(8) << nbExpanded
+         << " generated=" << setw(8) << graph.getNbGenerated()
+         << " hits=" << setw(8) << graph.getNbCacheHits()
+         << fixed << setprecision(3)
+         << " setup=" << setupMs << "ms"
+         << " dives=" << divesMs << "ms"
+         << " peakRss=" << getPeakRssKb() << "KB" << endl;
+}
+
+static void runBuilt(TemporalBPData & data, bool reduced, int nbDives){
+    auto start = chrono::steady_clock::now();
+    data._graph = reduced ? data.buildReducedGraph() : data.buildGraph();
+    const double setupMs = elapsedMs(start);
+    const LayeredGraph & graph = data._graph;
+
+    mt19937 generator(1);
+    long nbExpanded = 0;
+    const int sink = graph.getNbVertices() - 1;
+    start = chrono::steady_clock::now();
+    for (int d = 0; d < nbDives; d++) {
+        const vector<double> duals = drawDuals(data.getNbItems(), generator);
+        int vertex = 0;
+        while (vertex != sink) {
+            int best = 0;
+            double bestWeight = -1;
+            for (int a = graph._arcOffsets[vertex]; a < graph._arcOffsets[vertex + 1]; a++) {
+                double weight = 0;
+                for (int k = graph._arcItemOffsets[a]; k < graph._arcItemOffsets[a + 1]; k++)
+                    weight += duals[graph._arcItems[k]];
+                if (weight > bestWeight) {
+                    best = graph._arcSuccessors[a];
+                    bestWeight = weight;
+                }
+            }
+            vertex = best;
+            nbExpanded++;
+        }
+    }
+    const double divesMs = elapsedMs(start);
+
+    cout << "built    items=" << setw(6) << left << data.getNbItems()
+         << " vertices=" << setw(9) << graph.getNbVertices()
+         << " arcs=" << setw(10) << graph.getNbArcs()
+         << " expanded=" << setw(8) << nbExpanded
+         << fixed << setprecision(3)
+         << " setup=" << setupMs << "ms"
+         << " dives=" << divesMs << "ms"
+         << " peakRss=" << getPeakRssKb() << "KB" << endl;
+}
+
+int main(int argc, char * argv[]){
+    vector<int> sizes = {500, 2000, 5000};
+    int nbDives = 100;
+    size_t cacheSize = 1 << 16;
+    bool reduced = false;
+    for (int a = 1; a + 1 < argc; a += 2) {
+        const string option = argv[a];
+        if (option == "--sizes") sizes = parseSizes(argv[a + 1]);
+        else if (option == "--dives") nbDives = atoi(argv[a + 1]);
+        else if (option == "--cache") cacheSize = atol(argv[a + 1]);
+        else if (option == "--reduced") reduced = (string(argv[a + 1]) == "1");
+        else {
+            cerr << "<benchImplicit> Invalid option " << option << endl;
+            return 1;
+        }
+    }
+
+    for (const auto & nbItems : sizes) {
+        GeneratorParams params;
+        params._nbItems = nbItems;
+        params._capacity = 100;
+        params._minSize = 5;
+        params._maxSize = 40;
+        params._minLength = 40;
+        params._maxLength = 80;
+        params._overlap = 8;
+        for (int implicit = 1; implicit >= 0; implicit--) {
+            const bool ok = runInChild([&](){
+                TemporalBPData data(params._capacity, generateItems(params, 1));
+                if (implicit)
+                    runImplicit(data, reduced, nbDives, cacheSize);
+                else
+                    runBuilt(data, reduced, nbDives);
+            });
+            if (!ok)
+                cerr << "<benchImplicit> Run with " << nbItems << " items failed" << endl;
+        }
+    }
+}
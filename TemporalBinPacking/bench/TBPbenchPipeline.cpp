@@ -0,0 +1,345 @@
+//
+// Created by lhirwashema on 2022-07-21.
+//
+// Runs the stages of the TBP pipeline on generated instances of increasing size, for the normal
+// and the reduced graph, and prints one line per run in CSV (default) or JSON lines:
+// wall time of each stage, heap allocations of the graph construction, peak RSS,
+// the sizes of the cliques, combinations and graph, and the bounds computed with and without the graph.
+// Each run is forked (runInChild), its peak RSS being measured apart from the others.
+//
+// Usage: TBPbenchPipeline [--sizes 100,200,...] [--seeds n] [--capacity c] [--overlap x]
+//                         [--min-size a] [--max-size b] [--size-dist d]
+//                         [--min-length a] [--max-length b] [--length-dist d]
+//                         [--prune 0|1] [--updates n] [--arena 0|1] [--format csv|json] [--write folder]
+//                         [--check-mapped n]
+// with d among uniform, normal, exponential and bimodal.
+// With --updates n, the graph keeps its combinations and n items are then added, removed or moved in turn,
+// the average time of an update being reported. --arena 0 allocates the columns on the heap (see TBParena.hpp).
+// With --check-mapped n, the graphs of n small instances are loaded from a cache (see TBPcache.hpp), with the counts
+// of their pruning, and changed once their instance is gone, which have to give back the graph built in memory.
+//
+
+#include "../include/TBPbounds.hpp"
+#include "../include/TBPcache.hpp"
+#include "../include/TBPdata.hpp"
+#include "../include/TBPgenerator.hpp"
+#include "../include/TBPsolver.hpp"
+#include "TBPbench.hpp"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <dirent.h>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <new>
+#include <string>
+
+using namespace std;
+
+static atomic<long> nbHeapAllocations(0);    ///< calls to operator new of the process, arena chunks excluded
+
+void * operator new(size_t size){
+    nbHeapAllocations++;
+    if (void * p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void * p) noexcept {
+    free(p);
+}
+
+void operator delete(void * p, size_t) noexcept {
+    free(p);
+}
+
+/**
+ * Measures of one run, in the order of the output columns
+ */
+class BenchResult {
+public:
+    int _nbItems;
+    unsigned int _seed;
+    bool _reduced;
+    double _sortMs;          ///< sorting and renumbering the items
+    double _cliquesMs;       ///< maximum (or reduced) cliques
+    double _combosMs;        ///< feasible combinations of every clique
+    double _graphMs;         ///< whole graph construction, cliques and combinations included
+    double _boundsMs;        ///< greedy upper bound and lower bound on the graph
+    double _itemBoundsMs;    ///< bounds of TBPbounds.hpp, without the graph
+    int _nbCliques;
+    int _maxWidth;           ///< largest clique
+    long _nbCombos;
+    int _maxNbCombosClique;
+    int _nbVertices;
+    int _nbArcs;
+    int _upperBound;
+    int _lowerBound;
+    int _firstFit;           ///< bins of the first fit over time
+    int _cliqueBound;        ///< size and L2 bounds of the maximum cliques
+    long _nbDominatedVertices;   ///< removed by the dominance pruning, with --prune 1
+    long _nbDominatedArcs;
+    double _updateMs;        ///< average time of an incremental update, with --updates n
+    long _graphAllocations;  ///< calls to operator new during the graph construction
+    long _peakRssKb;
+
+    static string getCsvHeader(){
+        return "items,seed,graph,sort_ms,cliques_ms,combos_ms,graph_ms,bounds_ms,cliques,max_width,"
+               "combos,max_combos_clique,vertices,arcs,upper_bound,lower_bound,item_bounds_ms,first_fit,clique_bound,pruned_vertices,pruned_arcs,update_ms,graph_allocs,peak_rss_kb";
+    }
+
+    string toCsv() const {
+        ostringstream out;
+        out << _nbItems << "," << _seed << "," << (_reduced ? "reduced" : "normal") << ","
+            << _sortMs << "," << _cliquesMs << "," << _combosMs << "," << _graphMs << "," << _boundsMs << ","
+            << _nbCliques << "," << _maxWidth << "," << _nbCombos << "," << _maxNbCombosClique << ","
+            << _nbVertices << "," << _nbArcs << "," << _upperBound << "," << _lowerBound << ","
+            << _itemBoundsMs << "," << _firstFit << "," << _cliqueBound << ","
+            << _nbDominatedVertices << "," << _nbDominatedArcs << "," << _updateMs << "," << _graphAllocations << "," << _peakRssKb;
+        return out.str();
+    }
+
+    string toJson() const {
+        ostringstream out;
+        out << "{\"items\":" << _nbItems << ",\"seed\":" << _seed
+            << ",\"graph\":\"" << (_reduced ? "reduced" : "normal") << "\""
+            << ",\"sort_ms\":" << _sortMs << ",\"cliques_ms\":" << _cliquesMs << ",\"combos_ms\":" << _combosMs
+            << ",\"graph_ms\":" << _graphMs << ",\"bounds_ms\":" << _boundsMs
+            << ",\"cliques\":" << _nbCliques << ",\"max_width\":" << _maxWidth << ",\"combos\":" << _nbCombos
+            << ",\"max_combos_clique\":" << _maxNbCombosClique << ",\"vertices\":" << _nbVertices
+            << ",\"arcs\":" << _nbArcs << ",\"upper_bound\":" << _upperBound << ",\"lower_bound\":" << _lowerBound
+            << ",\"item_bounds_ms\":" << _itemBoundsMs << ",\"first_fit\":" << _firstFit << ",\"clique_bound\":" << _cliqueBound
+            << ",\"pruned_vertices\":" << _nbDominatedVertices << ",\"pruned_arcs\":" << _nbDominatedArcs
+            << ",\"update_ms\":" << _updateMs << ",\"graph_allocs\":" << _graphAllocations
+            << ",\"peak_rss_kb\":" << _peakRssKb << "}";
+        return out.str();
+    }
+};
+
+/**
+ * Adds, removes and moves items in turn, with the sizes and lengths of the generator, and returns the average time
+ */
+static double runUpdates(TemporalBPData & data, const GeneratorParams & params, unsigned int seed, int nbUpdates){
+    mt19937 generator(seed);
+    uniform_int_distribution<int> drawSize(params._minSize, params._maxSize);
+    uniform_int_distribution<int> drawEntry(0, params.getHorizon() - 1);
+    uniform_int_distribution<int> drawLength(params._minLength, params._maxLength);
+    auto start = chrono::steady_clock::now();
+    for (int u = 0; u < nbUpdates; u++) {
+        const int entry = drawEntry(generator);
+        const int exit = entry + drawLength(generator);
+        const int id = uniform_int_distribution<int>(0, max(data.getNbItems() - 1, 0))(generator);
+        if (u % 3 == 0 || data.getNbItems() == 0)
+            data.addItem(drawSize(generator), entry, exit);
+        else if (u % 3 == 1)
+            data.removeItem(id);
+        else    ///< moved a little, as a rescheduled job
+            data.updateItem(id, data._items[id]._size, data._items[id]._entry + 1, data._items[id]._exit + 1);
+    }
+    return nbUpdates > 0 ? elapsedMs(start) / nbUpdates : 0;
+}
+
+static BenchResult runPipeline(const GeneratorParams & params, unsigned int seed, bool reduced, bool prune, int nbUpdates, bool arena){
+    BenchResult result;
+    result._nbItems = params._nbItems;
+    result._seed = seed;
+    result._reduced = reduced;
+    vector<Item> items = generateItems(params, seed);
+
+    auto start = chrono::steady_clock::now();
+    TemporalBPData data(params._capacity, items);
+    result._sortMs = elapsedMs(start);
+
+    start = chrono::steady_clock::now();
+    vector<vector<int>> cliques = reduced ? data.getReducedCliques() : data.getMaxCliqueSet().toVectors();
+    result._cliquesMs = elapsedMs(start);
+    result._nbCliques = cliques.size();
+    result._maxWidth = 0;
+    for (const auto & clique : cliques)
+        result._maxWidth = max(result._maxWidth, (int)clique.size());
+
+    start = chrono::steady_clock::now();
+    result._nbCombos = 0;
+    for (const auto & clique : cliques)
+        result._nbCombos += data.getFeasibleCombos(clique).size();
+    result._combosMs = elapsedMs(start);
+
+    start = chrono::steady_clock::now();
+    TBPBounds bounds = computeBounds(data);
+    result._itemBoundsMs = elapsedMs(start);
+    result._firstFit = bounds.getUpperBound();
+    result._cliqueBound = bounds._lowerBound;
+
+    start = chrono::steady_clock::now();
+    data._buildOptions._dominancePruning = prune;
+    data._buildOptions._incremental = nbUpdates > 0;
+    data._buildOptions._useArena = arena;
+    const long nbAllocations = nbHeapAllocations;
+    data._graph = reduced ? data.buildReducedGraph() : data.buildGraph();
+    result._graphMs = elapsedMs(start);
+    result._graphAllocations = nbHeapAllocations - nbAllocations;
+    result._maxNbCombosClique = data.getMaxNbCombosClique();
+    result._nbVertices = data._graph.getNbVertices();
+    result._nbArcs = data._graph.getNbArcs();
+    result._nbDominatedVertices = data._nbDominatedVertices;
+    result._nbDominatedArcs = data._nbDominatedArcs;
+
+    start = chrono::steady_clock::now();
+    TBPSolver solver(data);
+    result._upperBound = solver.solveGreedy()._nbBins;
+    result._lowerBound = solver.computeLowerBound();
+    result._boundsMs = elapsedMs(start);
+
+    result._updateMs = runUpdates(data, params, seed, nbUpdates);
+
+    result._peakRssKb = getPeakRssKb();
+    return result;
+}
+
+static bool haveSameArrays(const LayeredGraph & first, const LayeredGraph & second){
+    for (int k = 0; k < NB_GRAPH_ARRAYS; k++) {
+        const IntSpan & a = first.getArray(GraphArray(k));
+        const IntSpan & b = second.getArray(GraphArray(k));
+        if (a.size() != b.size() || !equal(a.begin(), a.end(), b.begin()))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Maps the graphs of n small instances from a cache, one of three pruned, whose counts of pruned vertices and arcs
+ * have to be those of the build. The graphs are then changed after their instance is gone, renumbering
+ * the items of a column by the identity and splicing in a sink like the one replaced: the arrays copied out of
+ * the mapping have to be those the changes read, and the graph has to stay the one built in memory.
+ * Returns the number of graphs that differ
+ */
+static int checkMappedGraphs(int n){
+    char folder[] = "/tmp/TBPbenchPipelineXXXXXX";
+    if (mkdtemp(folder) == nullptr) {
+        cerr << "<benchPipeline> Cannot create a cache folder" << endl;
+        return 1;
+    }
+    int nbFailures = 0;
+    int nbPruned = 0;   ///< graphs that lost vertices to the pruning
+    for (int seed = 1; seed <= n; seed++) {
+        GeneratorParams params;
+        params._nbItems = 8 + seed % 30;
+        params._capacity = 10;
+        params._minSize = 1;
+        params._maxSize = 6;
+        params._horizon = 10 + seed % 15;
+        params._minLength = 1;
+        params._maxLength = 8;
+        const vector<Item> items = generateItems(params, seed);
+        const bool reduced = seed % 2 == 0;
+        LayeredGraph built;
+        LayeredGraph renumbered;
+        LayeredGraph spliced;
+        {   ///< the first instance builds the graph and writes it, the second one maps it
+            GraphBuildOptions options;
+            options._cacheFolder = folder;
+            options._dominancePruning = seed % 3 == 0;
+            const TemporalBPData first(params._capacity, items, reduced, options);
+            built = first._graph;
+            nbPruned += first._nbDominatedVertices > 0;
+            TemporalBPData data(params._capacity, items, reduced, options);
+            if (!data._graph.isMapped() || data._nbDominatedVertices != first._nbDominatedVertices
+             || data._nbDominatedArcs != first._nbDominatedArcs) {
+                cerr << "<benchPipeline> Seed " << seed << ": graph or pruning counts not mapped from the cache" << endl;
+                nbFailures++;
+                continue;
+            }
+            renumbered = data._graph;
+            spliced = data._graph;
+        }
+        vector<int> identity(items.size());
+        for (int i = 0; i < (int)identity.size(); i++)
+            identity[i] = i;
+        renumbered.renumberItems(min(1, renumbered.getNbColumns() - 1), identity);
+        GraphColumn sink;
+        sink.closeVertex();
+        spliced.replaceColumns(spliced.getNbColumns() - 1, spliced.getNbColumns(), &sink, 1);
+        if (renumbered.isMapped() || spliced.isMapped() || !haveSameArrays(built, renumbered) || !haveSameArrays(built, spliced)) {
+            cerr << "<benchPipeline> Seed " << seed << ": mapped graph changed by the renumbering or the splice" << endl;
+            nbFailures++;
+        }
+    }
+    if (DIR * dir = opendir(folder)) {
+        while (dirent * entry = readdir(dir))
+            if (entry->d_name[0] != '.')
+                remove((string(folder) + "/" + entry->d_name).c_str());
+        closedir(dir);
+    }
+    rmdir(folder);
+    cout << "check-mapped instances=" << n << " pruned=" << nbPruned << " failures=" << nbFailures << endl;
+    return nbFailures;
+}
+
+int main(int argc, char * argv[]){
+    vector<int> sizes = {100, 200, 500, 1000, 2000, 5000};
+    int nbSeeds = 1;
+    bool json = false;
+    bool prune = false;
+    int nbUpdates = 0;
+    bool arena = true;
+    int nbMappedChecks = 0;
+    string writeFolder;
+    GeneratorParams params;
+    params._capacity = 100;
+    params._minSize = 5;
+    params._maxSize = 40;
+    params._minLength = 40;
+    params._maxLength = 80;
+    params._overlap = 8;
+
+    for (int a = 1; a + 1 < argc; a += 2) {
+        const string option = argv[a];
+        const string value = argv[a + 1];
+        bool ok = true;
+        if (option == "--sizes") sizes = parseSizes(value);
+        else if (option == "--seeds") nbSeeds = atoi(value.c_str());
+        else if (option == "--capacity") params._capacity = atoi(value.c_str());
+        else if (option == "--overlap") params._overlap = atof(value.c_str());
+        else if (option == "--min-size") params._minSize = atoi(value.c_str());
+        else if (option == "--max-size") params._maxSize = atoi(value.c_str());
+        else if (option == "--size-dist") ok = parseDistribution(value, params._sizeDistribution);
+        else if (option == "--min-length") params._minLength = atoi(value.c_str());
+        else if (option == "--max-length") params._maxLength = atoi(value.c_str());
+        else if (option == "--length-dist") ok = parseDistribution(value, params._lengthDistribution);
+        else if (option == "--prune") prune = (value == "1");
+        else if (option == "--updates") nbUpdates = atoi(value.c_str());
+        else if (option == "--arena") arena = (value == "1");
+        else if (option == "--format") json = (value == "json");
+        else if (option == "--write") writeFolder = value;
+        else if (option == "--check-mapped") nbMappedChecks = atoi(value.c_str());
+        else ok = false;
+        if (!ok) {
+            cerr << "<benchPipeline> Invalid option " << option << " " << value << endl;
+            return 1;
+        }
+    }
+
+    if (nbMappedChecks > 0)
+        return checkMappedGraphs(nbMappedChecks) == 0 ? 0 : 1;
+
+    if (!json)
+        cout << BenchResult::getCsvHeader() << endl;
+    for (const auto & nbItems : sizes) {
+        params._nbItems = nbItems;
+        for (unsigned int seed = 1; seed <= (unsigned int)nbSeeds; seed++) {
+            if (!writeFolder.empty()) {
+                ofstream out(writeFolder + "/gen_" + to_string(nbItems) + "_" + to_string(seed) + ".txt");
+                writeInstance(out, params._capacity, generateItems(params, seed));
+            }
+            for (int reduced = 0; reduced <= 1; reduced++) {
+                const bool ok = runInChild([&](){
+                    BenchResult result = runPipeline(params, seed, reduced, prune, nbUpdates, arena);
+                    cout << (json ? result.toJson() : result.toCsv()) << endl;
+                });
+                if (!ok)
+                    cerr << "<benchPipeline> Run with " << nbItems << " items, seed " << seed
+                         << (reduced ? ", reduced graph" : ", normal graph") << " failed" << endl;
+            }
+        }
+    }
+}
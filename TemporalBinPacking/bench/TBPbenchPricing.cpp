@@ -0,0 +1,84 @@
+//
+// Created by lhirwashema on 2022-08-01.
+//
+// Builds the graph of generated instances once, then prices it again and again with new duals, as a
+// column generation does, and prints the time of the build next to the average time of a pricing call:
+// setting the duals, then finding the best path and the k best paths.
+//
+// Usage: TBPbenchPricing [--sizes 500,2000,...] [--iterations n] [--k n]
+//
+
+#include "../include/TBPdata.hpp"
+#include "../include/TBPgenerator.hpp"
+#include "../include/TBPpricing.hpp"
+#include "TBPbench.hpp"
+#include <iomanip>
+#include <random>
+#include <string>
+
+using namespace std;
+
+int main(int argc, char * argv[]){
+    vector<int> sizes = {500, 2000, 5000};
+    int nbIterations = 20;
+    int k = 10;
+    for (int a = 1; a + 1 < argc; a += 2) {
+        const string option = argv[a];
+        if (option == "--sizes") sizes = parseSizes(argv[a + 1]);
+        else if (option == "--iterations") nbIterations = atoi(argv[a + 1]);
+        else if (option == "--k") k = atoi(argv[a + 1]);
+        else {
+            cerr << "<benchPricing> Invalid option " << option << endl;
+            return 1;
+        }
+    }
+
+    for (const auto & nbItems : sizes) {
+        GeneratorParams params;
+        params._nbItems = nbItems;
+        params._capacity = 100;
+        params._minSize = 5;
+        params._maxSize = 40;
+        params._minLength = 40;
+        params._maxLength = 80;
+        params._overlap = 8;
+        TemporalBPData data(params._capacity, generateItems(params, 1));
+
+        auto start = chrono::steady_clock::now();
+        data._graph = data.buildGraph();
+        const double buildMs = elapsedMs(start);
+
+        TBPPricer pricer(data._graph, data.getNbItems());
+        mt19937 generator(1);
+        uniform_real_distribution<double> drawDual(0, 0.5);
+        vector<double> duals(data.getNbItems());
+        double dualsMs = 0, bestMs = 0, bestKMs = 0, bestCost = 0;
+        for (int it = 0; it < nbIterations; it++) {
+            for (auto & dual : duals)
+                dual = drawDual(generator);
+            start = chrono::steady_clock::now();
+            pricer.setDuals(duals);
+            dualsMs += elapsedMs(start);
+
+            start = chrono::steady_clock::now();
+            PricingPath path;
+            if (pricer.findBestPath(path))
+                bestCost += path._reducedCost;
+            bestMs += elapsedMs(start);
+
+            start = chrono::steady_clock::now();
+            pricer.findBestPaths(k);
+            bestKMs += elapsedMs(start);
+        }
+
+        cout << "items=" << setw(6) << left << nbItems
+             << " vertices=" << setw(9) << data._graph.getNbVertices()
+             << " arcs=" << setw(9) << data._graph.getNbArcs()
+             << fixed << setprecision(3)
+             << " build=" << buildMs << "ms"
+             << " setDuals=" << dualsMs / nbIterations << "ms"
+             << " best=" << bestMs / nbIterations << "ms"
+             << " best" << k << "=" << bestKMs / nbIterations << "ms"
+             << " avgReducedCost=" << bestCost / nbIterations << endl;
+    }
+}
@@ -0,0 +1,117 @@
+//
+// Created by lhirwashema on 2022-08-03.
+//
+
+#pragma once
+
+#include "TBPcliques.hpp"
+#include "TBPdata.hpp"
+#include "TBPgraph.hpp"
+#include "TBPsolver.hpp"
+
+/**
+ * Items grouped into types of interchangeable items.
+ *
+ * Every instant of a bin lies within a maximum clique, whose items are all present at one common date, so a bin
+ * is feasible when the sizes of its items sum up to at most the capacity within every maximum clique. Two items of
+ * the same size that belong to the same maximum cliques can thus be swapped in any bin: they form a type, whatever
+ * their exact dates. Types are numbered by their first item, so they follow the chronological order of the items.
+ *
+ * Only such items are grouped. Items of one size whose windows are nested are not interchangeable: the longer one,
+ * put in the place of the shorter one, may overload the bin at the dates the shorter one is absent, so they stay
+ * in types of their own.
+ * The reduced cliques are subsets of the maximum cliques, so the sum check holds on them as well, but the reduced
+ * graph is a relaxation whose paths may not be valid, while an aggregated solution meeting its bound is final:
+ * the types are built over the maximum cliques only, and the batches aggregate with the normal method only
+ */
+class ItemTypes {
+public:
+    vector<int> _typeOfItem;    ///< type of each item, by item ID
+    vector<int> _sizes;         ///< size of each type
+    vector<int> _itemOffsets;   ///< items of type t are _items[_itemOffsets[t]] ... _items[_itemOffsets[t+1]-1], by increasing ID
+    vector<int> _items;
+    CliqueSet _cliques;         ///< types of each maximum clique, by increasing ID
+
+    ItemTypes() : _itemOffsets(1, 0) {}
+
+    int getNbTypes() const { return _sizes.size(); }
+    int getMultiplicity(int type) const { return _itemOffsets[type + 1] - _itemOffsets[type]; }
+};
+
+/**
+ * Groups the items into types, given the maximum cliques of the items
+ */
+ItemTypes groupIdenticalItems(const vector<Item> & items, const CliqueSet & cliques);
+
+/**
+ * Feasible multisets of the types of a clique: combination c takes _counts[c*getNbTypes()+k] items of type _types[k].
+ * A clique with k items of one type has k+1 combinations of them instead of 2^k
+ */
+class MultisetCombos {
+public:
+    vector<int> _types;
+    vector<int> _counts;
+
+    int getNbTypes() const { return _types.size(); }
+    int size() const { return _types.empty() ? 1 : _counts.size() / _types.size(); }
+    const int * getCounts(int c) const { return _counts.data() + (size_t)c * _types.size(); }
+};
+
+/**
+ * Enumerates the multisets of the types of a clique whose total size fits into a bin, the empty one included
+ */
+MultisetCombos enumerateMultisets(const ItemTypes & types, const int * cliqueBegin, const int * cliqueEnd, int capacity);
+
+/**
+ * Graph of the maximum cliques over the types of the items.
+ *
+ * It has the columns of TemporalBPData::buildGraph, but a vertex is a multiset of the types of its clique and its
+ * items are type IDs, each one repeated as many times as the multiset takes it; the same goes for the new items
+ * of the arcs. A vertex is linked to the multisets of the next clique that take as many items as it does of every
+ * type both cliques hold. Concrete item IDs only come back with the assignment of solveAggregated.
+ * A TBPPricer works on this graph as well, with one dual per type
+ */
+class AggregatedGraph {
+public:
+    ItemTypes _types;
+    LayeredGraph _graph;
+};
+
+/**
+ * Groups the items of data into types and builds their graph, the cliques being enumerated concurrently
+ * on data._buildOptions._nbWorkers threads
+ */
+AggregatedGraph buildAggregatedGraph(const TemporalBPData & data);
+
+/**
+ * Greedy decomposition of an aggregated graph into paths, one per bin, as TBPSolver::solveGreedy does on the graph
+ * of the items: each path is the heaviest one in the items not yet covered, an arc counting at most the items
+ * left of each of its types. The items of every type are then handed out to the bins that took that type.
+ * The lower bound is the largest number of bins needed by the items of one clique, and the solution is optimal
+ * when it meets it
+ */
+TBPSolution solveAggregated(const TemporalBPData & data, const AggregatedGraph & aggregated);
+
+/**
+ * Outcome of solving an instance on its aggregated graph before its graph of items
+ */
+class AggregationAttempt {
+public:
+    bool _solved;            ///< the greedy solution needs no more bins than the target or the lower bound
+    int _nbColumns;
+    int _nbVertices;
+    int _nbArcs;
+    long _graphBytes;        ///< arrays of the aggregated graph
+    double _graphMs;
+    double _solveMs;
+    TBPSolution _solution;   ///< left empty when some item is in no path
+
+    AggregationAttempt() : _solved(false), _nbColumns(0), _nbVertices(0), _nbArcs(0), _graphBytes(0), _graphMs(0), _solveMs(0) {}
+};
+
+/**
+ * Builds the aggregated graph of data and solves it with solveAggregated, the graph being freed on return.
+ * The attempt succeeds when every item is covered with at most max(target, lower bound of the cliques) bins,
+ * target being the number of bins the caller can do with; otherwise the solution may still start a TBPSolver
+ */
+AggregationAttempt trySolveAggregated(const TemporalBPData & data, int target);
@@ -0,0 +1,98 @@
+//
+// Created by lhirwashema on 2022-07-27.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Monotonic memory resource: allocations are carved out of large chunks one after the other
+ * and are never given back one by one, every chunk being freed at once by release() or by the destructor.
+ *
+ * The graph construction allocates the storage of its columns from one arena per build, so the many buffers
+ * of a build cost a few chunk allocations, do not fragment the heap of the other builds of the process,
+ * and go back to the system together once the graph is assembled.
+ * Allocations are serialized by a mutex, the workers of a build sharing its arena.
+ *
+ * Only these temporary columns live in the arena: LayeredGraph::assemble copies them into the arrays of the graph,
+ * which stay on the heap, one allocation per array sized once. Those arrays outlive the build, are mapped from the
+ * cache or spliced by TemporalBPData::updateGraph, and an arena never gives back the memory they
+ * would drop, so TemporalBPData owns no arena for them
+ */
+class MonotonicArena {
+public:
+    explicit MonotonicArena(size_t chunkSize = 1 << 20);
+    ~MonotonicArena();
+
+    MonotonicArena(const MonotonicArena &) = delete;
+    MonotonicArena & operator=(const MonotonicArena &) = delete;
+
+    void * allocate(size_t size, size_t alignment);
+
+    /**
+     * Frees every chunk, the memory allocated so far must not be used anymore
+     */
+    void release();
+
+    size_t getNbAllocations() const { return _nbAllocations; }
+    size_t getNbBytes() const { return _nbBytes; }           ///< bytes handed out
+    size_t getNbReservedBytes() const { return _nbReserved; } ///< bytes of the chunks
+    int getNbChunks() const { return _chunks.size(); }
+
+private:
+    mutex _mutex;
+    size_t _chunkSize;
+    vector<char *> _chunks;
+    char * _current;        ///< free space of the last regular chunk
+    size_t _left;
+    size_t _nbAllocations;
+    size_t _nbBytes;
+    size_t _nbReserved;
+};
+
+/**
+ * Allocator of the standard containers drawing from a MonotonicArena, or from the heap without arena.
+ * Deallocating arena memory does nothing: it is given back with the whole arena
+ */
+template <class T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef true_type propagate_on_container_copy_assignment;
+    typedef true_type propagate_on_container_move_assignment;
+    typedef true_type propagate_on_container_swap;
+
+    MonotonicArena * _arena;
+
+    ArenaAllocator(MonotonicArena * arena = nullptr) noexcept : _arena(arena) {}
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U> & allocator) noexcept : _arena(allocator._arena) {}
+
+    T * allocate(size_t n){
+        if (_arena)
+            return static_cast<T *>(_arena->allocate(n * sizeof(T), alignof(T)));
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T * p, size_t) noexcept {
+        if (!_arena)
+            ::operator delete(p);
+    }
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T> & a, const ArenaAllocator<U> & b){ return a._arena == b._arena; }
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T> & a, const ArenaAllocator<U> & b){ return a._arena != b._arena; }
+
+/**
+ * Vector of ints whose buffer may live in an arena
+ */
+typedef vector<int, ArenaAllocator<int>> ArenaIntVector;
@@ -0,0 +1,86 @@
+//
+// Created by lhirwashema on 2022-07-28.
+//
+
+#pragma once
+
+#include "TBPdata.hpp"
+#include <functional>
+#include <string>
+
+/**
+ * Settings of a batch of instances
+ */
+class BatchOptions {
+public:
+    bool _reduced;                    ///< builds the reduced graph instead of the normal one
+    bool _events;                     ///< builds the graph of the events of the items instead (see TBPevents.hpp)
+    bool _useBounds;                  ///< computes the bounds of TBPbounds.hpp first, the graph is skipped when they meet
+    bool _decompose;                  ///< solves the time components of an instance apart (see TBPdecomposition.hpp)
+    bool _aggregate;                  ///< tries the graph of the types of identical items first (see TBPaggregation.hpp)
+    int _nbWorkers;                   ///< instances solved concurrently
+    long _memoryBudgetKb;             ///< memory of the instances running together, 0 for no budget
+    GraphBuildOptions _buildOptions;  ///< construction of the graph of each instance, _nbWorkers being the threads of one build
+
+    BatchOptions() : _reduced(false), _events(false), _useBounds(true), _decompose(true), _aggregate(false), _nbWorkers(1), _memoryBudgetKb(0) {}
+};
+
+/**
+ * Outcome of one instance of a batch, in the order of the output columns
+ */
+class InstanceResult {
+public:
+    string _fileName;
+    string _error;           ///< empty when the instance was solved
+    int _nbItems;
+    int _nbComponents;       ///< connected components of the interval graph of the items
+    int _nbColumns;          ///< summed over the components, as the vertices and arcs
+    int _nbVertices;
+    int _nbArcs;
+    int _nbBins;
+    int _lowerBound;
+    bool _optimal;
+    bool _valid;             ///< the assignment passed isValidSolution
+    bool _closedByBounds;    ///< solved by the bounds, without any graph
+    double _parseMs;         ///< reading the file
+    double _boundsMs;        ///< bounds computed before the graph
+    double _graphMs;         ///< building the graph, cliques and combinations included
+    double _solveMs;         ///< solving the graph
+    string _graph;           ///< graph solved: normal, reduced, events, aggregated, components, none when refused, empty when the bounds met
+    long _estimatedGraphKb;  ///< footprint of that graph estimated before the build, with a graph budget
+
+    InstanceResult() : _nbItems(0), _nbComponents(0), _nbColumns(0), _nbVertices(0), _nbArcs(0), _nbBins(0), _lowerBound(0),
+                       _optimal(false), _valid(false), _closedByBounds(false), _parseMs(0), _boundsMs(0), _graphMs(0), _solveMs(0), _estimatedGraphKb(0) {}
+
+    bool isValid() const { return _error.empty(); }
+
+    static string getCsvHeader();
+    string toCsv() const;
+    string toJson() const;
+};
+
+/**
+ * Receives each result as soon as its instance is done, with the data of the instance (nullptr if the file
+ * could not be read). Calls never overlap, so the callback may write to a shared stream
+ */
+typedef function<void(const InstanceResult &, TemporalBPData *)> ResultCallback;
+
+/**
+ * Reads, builds and solves instance files concurrently on options._nbWorkers threads.
+ * With options._useBounds, an instance whose bounds meet is solved by its first fit and gets no graph.
+ * With options._decompose, the components of an instance are solved apart on the threads of its build.
+ * With options._aggregate, an instance built whole is first solved greedily on the graph of its types of identical
+ * items; the graph of the items is only built when that solution does not meet the lower bound, and starts from it.
+ * With a graph budget in options._buildOptions, the graph of an instance is picked by chooseGraph before anything is
+ * allocated (see TBPestimate.hpp): the reduced graph, then the aggregated one replace a graph over the budget, and an
+ * instance with no graph under it is reported as an error with its first fit.
+ *
+ * Every worker takes another instance once it is done with its own, so at most _nbWorkers instances
+ * are held in memory at a time. With a memory budget, an instance only starts building its graph once
+ * its estimated footprint fits next to the ones of the running instances, or when no other instance runs.
+ * Footprints are estimated from the graphs built so far (see MemoryGate in TBPbatch.cpp), so the budget
+ * is approximate: the dynamic program of the solver, in particular, is not accounted for.
+ * Returns the number of instances that could not be solved
+ */
+int runBatch(const vector<string> & fileNames, const BatchOptions & options, const ResultCallback & onResult);
+
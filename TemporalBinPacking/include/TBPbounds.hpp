@@ -0,0 +1,53 @@
+//
+// Created by lhirwashema on 2022-07-29.
+//
+
+#pragma once
+
+#include "TBPdata.hpp"
+#include "TBPsolver.hpp"
+
+/**
+ * Bounds on the number of bins computed from the items alone, before any graph is built.
+ *
+ * The items of a maximum clique are all present at the same date, so every classical bin packing bound
+ * of a clique bounds the number of bins from below. An assignment found by a first fit over time bounds it
+ * from above. When both meet, the assignment is optimal and neither the graph nor the dynamic program is needed
+ */
+class TBPBounds {
+public:
+    int _sizeBound;           ///< largest ceil(total size / capacity) over the maximum cliques
+    int _l2Bound;             ///< largest Martello-Toth L2 bound over the maximum cliques
+    int _lowerBound;          ///< max of the bounds above
+    TBPSolution _firstFit;    ///< assignment of the first fit over time, its number of bins being the upper bound
+
+    TBPBounds() : _sizeBound(0), _l2Bound(0), _lowerBound(0) {}
+
+    int getUpperBound() const { return _firstFit._nbBins; }
+    bool isClosed() const { return getUpperBound() <= _lowerBound; }
+};
+
+/**
+ * Computes the lower bounds over the maximum cliques and the first fit over time
+ */
+TBPBounds computeBounds(const TemporalBPData & data);
+
+/**
+ * ceil(total size / capacity)
+ */
+int computeSizeBound(const vector<int> & sizes, int capacity);
+
+/**
+ * L2 bound of Martello and Toth: for every threshold K <= capacity/2, items larger than capacity-K take a bin
+ * of their own, items larger than capacity/2 one bin each, and items of size at least K that fit with none
+ * of those need the remaining space. Runs in O(n log n)
+ */
+int computeL2Bound(vector<int> sizes, int capacity);
+
+/**
+ * Assigns the items by entry date to the first bin that has room for them until their exit,
+ * the items entering at the same date being taken by decreasing size.
+ * The items of a bin all entered no later than the new one, so its load can only decrease after that date
+ * and checking it at the entry is enough
+ */
+TBPSolution solveFirstFit(const TemporalBPData & data);
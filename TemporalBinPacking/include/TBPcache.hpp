@@ -0,0 +1,64 @@
+//
+// Created by lhirwashema on 2022-07-20.
+//
+
+#pragma once
+
+#include "TBPdata.hpp"
+#include <cstdint>
+#include <string>
+
+/**
+ * Binary file of a layered graph: a fixed header followed by the arrays of the graph,
+ * one after the other as 32-bit integers in the order of GraphArray.
+ * Files are written in the byte order of the machine, the magic number and the version telling them apart.
+ */
+class GraphFileHeader {
+public:
+    char _magic[4];                         ///< "TBPG"
+    uint32_t _version;
+    uint64_t _key;                          ///< hash of the instance, see hashGraphKey
+    int32_t _maxNbCombosClique;
+    int32_t _unused;
+    int64_t _nbDominatedVertices;           ///< removed by the dominance pruning, as TemporalBPData counts them
+    int64_t _nbDominatedArcs;
+    uint64_t _sizes[NB_GRAPH_ARRAYS];       ///< number of integers of each array
+};
+
+/**
+ * Hash of everything the graph depends on: the capacity, the reduced and pruning flags and the items
+ * in chronological order, as stored by TemporalBPData
+ */
+uint64_t hashGraphKey(int capacity, const vector<Item> & items, bool reduced, bool dominancePruning);
+
+/**
+ * Writes a graph to a temporary file of the same folder, then renames it,
+ * so that a reader never sees a partially written file
+ */
+bool writeGraphFile(const string & fileName, uint64_t key, const LayeredGraph & graph, int maxNbCombosClique,
+                    long nbDominatedVertices, long nbDominatedArcs, string & error);
+
+/**
+ * Maps a graph file and makes graph a view of its arrays, nothing being copied, the counts of the header going
+ * to the other arguments. Returns false if the file is missing, belongs to another key or is inconsistent
+ */
+bool mapGraphFile(const string & fileName, uint64_t key, LayeredGraph & graph, int & maxNbCombosClique,
+                  long & nbDominatedVertices, long & nbDominatedArcs, string & error);
+
+/**
+ * Folder of graph files, named after the key of their instance
+ */
+class GraphCache {
+public:
+    string _folder;
+
+    GraphCache(const string & folder) : _folder(folder) {}
+
+    string getFileName(uint64_t key) const;
+
+    /**
+     * Sets the graph of data from the cache, or builds it and adds it to the cache.
+     * Returns true on a cache hit. A cache that cannot be written only costs the build
+     */
+    bool loadOrBuild(TemporalBPData & data, bool reduced) const;
+};
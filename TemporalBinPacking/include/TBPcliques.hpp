@@ -0,0 +1,48 @@
+//
+// Created by lhirwashema on 2022-07-06.
+//
+
+#pragma once
+
+#include <vector>
+
+using namespace std;
+
+class Item;
+
+/**
+ * List of cliques stored in CSR layout:
+ * the items of clique c are _items[_offsets[c]] ... _items[_offsets[c+1]-1], in entry order
+ */
+class CliqueSet {
+public:
+    vector<int> _offsets;   ///< size getNbCliques()+1, starts with 0
+    vector<int> _items;     ///< items of all cliques, one after the other
+
+    CliqueSet() : _offsets(1, 0) {}
+    explicit CliqueSet(const vector<vector<int>> & cliques);
+
+    int getNbCliques() const { return _offsets.size() - 1; }
+    int getSize(int c) const { return _offsets[c + 1] - _offsets[c]; }
+    const int * begin(int c) const { return _items.data() + _offsets[c]; }
+    const int * end(int c) const { return _items.data() + _offsets[c + 1]; }
+
+    vector<int> getClique(int c) const { return vector<int>(begin(c), end(c)); }
+    vector<vector<int>> toVectors() const;
+
+    /**
+     * Closes the current clique, the items pushed since the last call belong to it
+     */
+    void closeClique() { _offsets.push_back(_items.size()); }
+};
+
+/**
+ * Sweep-line extraction of the maximum cliques of a list of items sorted by entry date,
+ * whose IDs are their positions in the list.
+ *
+ * Entries are read in order while exits wait in a min-heap keyed by exit date, which merges both event streams.
+ * A clique is closed at the first exit following an entry; the exits of that step are then removed
+ * from the ongoing items in one pass, which is paid for by copying the clique.
+ * Overall the extraction runs in O(n log n) plus the size of the output.
+ */
+CliqueSet sweepMaxCliques(const vector<Item> & items);
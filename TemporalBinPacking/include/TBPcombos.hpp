@@ -0,0 +1,106 @@
+//
+// Created by lhirwashema on 2022-07-04.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+class Item;
+
+/**
+ * Flat storage of the feasible combinations of a clique.
+ *
+ * A combination is a bitmask over the clique: bit k stands for the item _items[k].
+ * Every combination occupies _nbWords consecutive 64-bit words of _masks,
+ * so cliques wider than 64 items are handled with multi-word masks.
+ */
+class FeasibleCombos {
+public:
+    vector<int> _items;        ///< items of the clique, in entry order
+    int _nbWords;              ///< number of 64-bit words per combination
+    vector<uint64_t> _masks;   ///< combination c occupies the words [c*_nbWords, (c+1)*_nbWords)
+
+    FeasibleCombos() : _nbWords(1) {}
+
+    int size() const { return _nbWords == 0 ? 0 : _masks.size() / _nbWords; }
+    int getNbItems() const { return _items.size(); }
+
+    const uint64_t * getMask(int c) const { return &_masks[c * _nbWords]; }
+
+    /**
+     * Determines whether the k-th item of the clique belongs to combination c
+     */
+    bool contains(int c, int k) const { return (getMask(c)[k >> 6] >> (k & 63)) & 1; }
+
+    /**
+     * Appends the ids of the items of combination c to out, in entry order
+     */
+    template <class IntVector>
+    void appendItems(int c, IntVector & out) const {
+        const uint64_t * mask = getMask(c);
+        for (int w = 0; w < _nbWords; w++) {
+            for (uint64_t word = mask[w]; word; word &= word - 1)
+                out.push_back(_items[(w << 6) + __builtin_ctzll(word)]);
+        }
+    }
+
+    /**
+     * Number of items of combination c
+     */
+    int getNbItems(int c) const {
+        int nbItems = 0;
+        for (int w = 0; w < _nbWords; w++)
+            nbItems += __builtin_popcountll(getMask(c)[w]);
+        return nbItems;
+    }
+
+    vector<int> getItems(int c) const;
+
+    /**
+     * Removes the combinations that another combination extends with local items only,
+     * isLocal[k] telling whether the k-th item of the clique belongs to no neighbouring clique.
+     * The order of the remaining combinations is kept. Returns the number of combinations removed
+     */
+    int removeDominated(const vector<char> & isLocal);
+};
+
+/**
+ * Enumerates the feasible combinations of a clique as bitmasks.
+ *
+ * Items are added in entry order and the capacity is checked incrementally:
+ * the load at the entry of an item only counts the selected items that have not left yet,
+ * which gives exactly the answer of TemporalBPData::isFeasible without ever sorting a selection.
+ * A branch is cut as soon as no remaining item can fit next to the items that stay until the end of the clique.
+ */
+class ComboEnumerator {
+public:
+    ComboEnumerator(const vector<Item> & items, int capacity, const vector<int> & clique);
+    ComboEnumerator(const vector<const Item *> & cliqueItems, int capacity);
+
+    FeasibleCombos enumerate();
+
+    /**
+     * Capacity checks made by the last enumeration, only counted with TBP_PROFILE
+     */
+    long getNbChecks() const { return _nbChecks; }
+
+private:
+    int _capacity;
+    int _nbItems;
+    vector<int> _sizes;           ///< size of the k-th item of the clique
+    vector<int> _persistent;      ///< 1 if the k-th item is still there at the last entry of the clique
+    vector<int> _minSizeFrom;     ///< smallest size among items k..n-1
+    vector<int> _expireOffsets;   ///< CSR offsets into _expire, one list per position
+    vector<int> _expire;          ///< positions of the items leaving right before the entry of position k
+    vector<uint64_t> _current;    ///< combination being built
+    FeasibleCombos _combos;
+    long _nbChecks;
+
+    void init(vector<const Item *> sorted);
+    void explore(int k, int load, int persistentLoad);
+    void emit();
+};
@@ -2,11 +2,18 @@
 // Created by lhirwashema on 2022-06-01.
 //
 
+#pragma once
 
 #include <vector>
 #include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <string>
+
+#include "TBPcliques.hpp"
+#include "TBPcombos.hpp"
+#include "TBPgraph.hpp"
+#include "TBPprofile.hpp"
 
 using namespace std;
 
@@ -30,19 +37,41 @@ public:
 
 
 
-class Arc {
+/**
+ * Settings of the graph construction
+ */
+class GraphBuildOptions {
 public:
-    int _successorId;
-    vector<int> _newItems;
+    int _nbWorkers;        ///< threads building the columns, 1 builds everything on the calling thread
+    bool _indexedLinking;  ///< finds successors by their projection onto the shared items instead of testing every pair
+    string _cacheFolder;   ///< folder of the graph cache (see TBPcache.hpp), empty to always build the graph
+    bool _dominancePruning;   ///< keeps only the vertices that cannot take one more local item, see buildGraphFromCliques
+    bool _incremental;     ///< keeps the combinations of the graph, so that addItem, removeItem and updateItem only rebuild the cliques they change
+    bool _useArena;        ///< allocates the columns of a build from one MonotonicArena (see TBParena.hpp) instead of the heap
+    long _graphBudgetKb;   ///< largest estimated footprint of a graph built by a batch, 0 for no limit (see chooseGraph in TBPestimate.hpp)
+
+    GraphBuildOptions() : _nbWorkers(1), _indexedLinking(true), _dominancePruning(false), _incremental(false), _useArena(true),
+                          _graphBudgetKb(0) {}
 };
 
-class Vertex {
+/**
+ * Cliques and combinations of the last graph built, in chronological order.
+ * They are only kept with GraphBuildOptions::_incremental: after a change of the items,
+ * the columns of the cliques that did not change are left as they are in the graph
+ */
+class CliqueCombos {
 public:
-    int _id; 
-    vector<int> _items;
-    vector<Arc> _arcs;
-};
+    bool _reduced;                          ///< cliques of the reduced graph
+    CliqueSet _cliques;
+    vector<FeasibleCombos> _combos;         ///< combinations of each clique, once pruned
+    vector<FeasibleCombos> _plainCombos;    ///< with _dominancePruning, combinations before the pruning of the cliques that lost some
+    vector<long> _nbDominatedVertices;      ///< with _dominancePruning, per clique
+    vector<long> _nbDominatedArcs;          ///< with _dominancePruning, per clique, arcs towards the next column
 
+    CliqueCombos() : _reduced(false) {}
+
+    bool isEmpty() const { return _combos.empty(); }
+};
 
 
 /**
@@ -56,18 +85,29 @@ class TemporalBPData{
 public:
     int _capacity;           ///< capacity of a bin
     vector<Item> _items;     ///< list of objects
-    vector<vector<Vertex>> _graph;
+    LayeredGraph _graph;
     int _maxNbCombosClique;
+    GraphBuildOptions _buildOptions;
+    long _nbDominatedVertices;   ///< vertices and arcs of the plain graph removed by the dominance pruning
+    long _nbDominatedArcs;
+    vector<ColumnStats> _columnStats;    ///< measures of each clique of the last graph built, left empty without TBP_PROFILE
+    CliqueCombos _cliqueCombos;          ///< combinations of _graph, kept with _buildOptions._incremental
 
     TemporalBPData();   // dummy instance for tests
     TemporalBPData(bool reduced);   // dummy instance for tests
     TemporalBPData(std::ifstream &in); // read the instance from a file
     TemporalBPData(std::ifstream &in, bool reduced); // read the instance from a file
+    TemporalBPData(std::ifstream &in, bool reduced, const GraphBuildOptions & options); // read the instance from a file
+    TemporalBPData(int capacity, const vector<Item> & items); // items only, the graph is left empty
+    TemporalBPData(int capacity, const vector<Item> & items, bool reduced, const GraphBuildOptions & options); // items of a parsed instance
 
     int getNbItems() const { return _items.size(); }
     int getCapacity() const { return _capacity; }
-    int getNbColumns() const { return _graph.size(); }
-    int getUpperBound()   const { return getMaxNbCombosClique(); }
+    int getNbColumns() const { return _graph.getNbColumns(); }
+    /**
+     * Bins of a first fit over time of the items (see solveFirstFit in TBPbounds.hpp)
+     */
+    int getUpperBound() const;
     // Implement parsers
     // Clean up everything
     int getMaxNbCombosClique() const { return _maxNbCombosClique; }
@@ -77,6 +117,11 @@ public:
      */
     vector<vector<int>> getMaxCliques();
 
+    /**
+     * Computes the maximum cliques with a sweep line over entry and exit dates, in CSR layout
+     */
+    CliqueSet getMaxCliqueSet() const;
+
     /**
      * Determines whether a selection of items can be packed into one bin
      * without violating the capacity constraint
@@ -89,16 +134,100 @@ public:
      */
     vector<vector<int>> getFeasibleCombinations(vector<int> clique);
 
+    /**
+     * Computes the feasible combinations of a clique as bitmasks stored in one flat buffer.
+     * The clique is expected in entry order, as returned by getMaxCliques
+     */
+    FeasibleCombos getFeasibleCombos(const vector<int> & clique) const;
+
+    /**
+     * Former recursive enumeration, kept as a reference for the benchmarks
+     */
+    vector<vector<int>> getFeasibleCombinationsRecursive(vector<int> clique);
+
     /**
      * Computes a graph to modelize the TBP problem as a minimum cost flow problem.
-     * The graph is constructed from sink to start, linking each created vertex to its predecessor in the next step
+     * Each vertex of a clique is linked to its successors in the next clique, the columns being in chronological order
      */
-    vector<vector<Vertex>> buildGraph();
+    LayeredGraph buildGraph();
 
     vector<vector<int>> getReducedCliques();
     
-    vector<vector<Vertex>> buildReducedGraph();
+    LayeredGraph buildReducedGraph();
 
+    /**
+     * Row of a vertex in its column, or -1 if the vertex is not in that column
+     */
     int getVertexYPos(int vertexId, int column);
 
+    /**
+     * Adds an item and returns its ID, which is its rank by entry date: the items entering later are renumbered.
+     * If the items have a graph, only the columns of the cliques the item changes are built again (see updateGraph)
+     */
+    int addItem(int size, int entry, int exit);
+
+    /**
+     * Removes an item, the items entering later are renumbered. Returns false if there is no such item
+     */
+    bool removeItem(int id);
+
+    /**
+     * Changes the size and dates of an item and returns its new ID, or -1 if there is no such item
+     */
+    int updateItem(int id, int size, int entry, int exit);
+
+    /**
+     * Sets _graph, from the cache of _buildOptions if there is one
+     */
+    void createGraph(bool reduced);
+
+private:
+    /**
+     * Renumbers the items in entry order once one of them was added, removed or changed, that one having the ID -1,
+     * and brings the graph up to date. The other items still have their former IDs, among nbOldItems
+     */
+    void renumberItems(int nbOldItems);
+
+    /**
+     * Brings the graph up to date after a change of the items, oldToNew giving the new ID of every former item
+     * (-1 for the item that was removed or changed).
+     *
+     * The cliques are computed again and compared with the former ones: those that hold the same items at both ends
+     * of the list keep their columns, only renumbered, and the others are enumerated and linked again,
+     * together with the column linked to the first of them. These columns then replace the former ones in the graph.
+     * Without kept combinations, the whole graph is built again
+     */
+    void updateGraph(const vector<int> & oldToNew);
+
+    /**
+     * Enumerates the combinations of cliques [first, last) into state and their vertices into columns (one per clique,
+     * after the start), then links the columns of cliques [first-1, last) to the next ones.
+     * The vertices of the columns of cliques first-1 and last, needed for the links, come from the kept combinations
+     */
+    void buildColumns(CliqueCombos & state, vector<GraphColumn> & columns, int first, int last);
+
+    /**
+     * Sets the start and the sink columns and the measures of the whole graph from state
+     */
+    void finishColumns(const CliqueCombos & state, vector<GraphColumn> & columns);
+
+    /**
+     * Builds the graph with one column per clique.
+     * Combinations of all cliques are enumerated concurrently, then every column is linked to the next one
+     * concurrently, and the columns are finally assembled in chronological order.
+     *
+     * With _dominancePruning, the items of a clique that belong to no neighbouring clique (local items) play
+     * no part in the arcs, so the vertices that agree on the other items are interchangeable on a path.
+     * Among them, only the vertices to which no local item can be added are kept: a bin holding a subset
+     * of a kept vertex is still described by that vertex, feasibility being hereditary.
+     * Paths then cover the items instead of partitioning them, which the solver takes into account.
+     */
+    LayeredGraph buildGraphFromCliques(const CliqueSet & cliques, bool reduced);
+
+    /**
+     * Creates the arcs of the vertices of column a+1 (clique a) towards column a+2 (clique a+1)
+     * by testing every pair of vertices
+     */
+    void linkColumn(const CliqueSet & cliques, int a, GraphColumn & column, const GraphColumn & next) const;
+
 };
\ No newline at end of file
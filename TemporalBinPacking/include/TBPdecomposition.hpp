@@ -0,0 +1,74 @@
+//
+// Created by lhirwashema on 2022-07-30.
+//
+
+#pragma once
+
+#include "TBPdata.hpp"
+#include "TBPestimate.hpp"
+#include "TBPsolver.hpp"
+
+/**
+ * Splits the items into the connected components of their interval graph.
+ * Items being sorted by entry date, a component ends where every item entered so far has left,
+ * so the components are ranges of IDs: component k holds the items offsets[k] ... offsets[k+1]-1.
+ * Returns the offsets, of size nbComponents+1
+ */
+vector<int> getTimeComponents(const vector<Item> & items);
+
+/**
+ * Items of IDs [first, last) as an instance of their own, with the build options of data.
+ * Their IDs become ID - first, in the same order, and the graph is left empty
+ */
+TemporalBPData extractComponent(const TemporalBPData & data, int first, int last);
+
+/**
+ * Outcome of one component of an instance
+ */
+class ComponentResult {
+public:
+    int _first;              ///< IDs of the items of the component
+    int _last;
+    bool _closedByBounds;    ///< solved by its first fit, without any graph
+    GraphChoice _graph;      ///< graph solved under the graph budget of the build options, GRAPH_NONE keeps the first fit
+    int _nbColumns;
+    int _nbVertices;
+    int _nbArcs;
+    long _graphBytes;        ///< arrays of its graph
+    double _graphMs;
+    double _solveMs;
+    TBPSolution _solution;   ///< bins of the items of the component, by ID - _first
+
+    ComponentResult() : _first(0), _last(0), _closedByBounds(false), _graph(GRAPH_NORMAL), _nbColumns(0), _nbVertices(0), _nbArcs(0),
+                        _graphBytes(0), _graphMs(0), _solveMs(0) {}
+};
+
+/**
+ * Solution of an instance assembled from its components
+ */
+class DecomposedSolution {
+public:
+    TBPSolution _solution;
+    vector<ComponentResult> _components;
+
+    long getNbVertices() const;
+    long getNbArcs() const;
+    long getMaxGraphBytes() const;   ///< largest graph of a component
+    bool isOverBudget() const;       ///< some component got no graph under the graph budget
+};
+
+/**
+ * Solves the components of an instance independently on nbWorkers threads, each component being built
+ * with a single thread, and merges their solutions.
+ *
+ * No item of a component is present at the same date as an item of another one, so the bins of the components
+ * are reused: item i of a component goes to the bin of its own solution, and the instance needs as many bins
+ * as its largest component. The bounds of the components are computed first: a component whose first fit does
+ * not use more bins than the largest lower bound cannot raise the number of bins, so it keeps its first fit and
+ * gets no graph. The graph of a component is freed as soon as it is solved, so only the components being solved
+ * take memory at a time. With aggregate, a component is first solved on the graph of its types of identical items
+ * (see trySolveAggregated), and only gets a graph of its items when that needs more bins than the lower bound.
+ * With a graph budget in the build options of data, a component gets the graph picked by chooseGraph.
+ * With events, the components get the graph of buildEventGraph instead, reduced and aggregate being ignored
+ */
+DecomposedSolution solveByComponents(const TemporalBPData & data, bool reduced, int nbWorkers, bool aggregate = false, bool events = false);
@@ -0,0 +1,99 @@
+//
+// Created by lhirwashema on 2022-08-04.
+//
+
+#pragma once
+
+#include "TBPcliques.hpp"
+#include "TBPdata.hpp"
+
+/**
+ * Size of one column of a graph, counted before it is built
+ */
+class CliqueEstimate {
+public:
+    double _nbCombos;      ///< vertices of the column
+    double _nbItems;       ///< items of its vertices, summed
+    double _nbArcs;        ///< arcs towards the next column (the sink for the last clique)
+    double _nbArcItems;    ///< new items of these arcs, summed
+
+    CliqueEstimate() : _nbCombos(0), _nbItems(0), _nbArcs(0), _nbArcItems(0) {}
+};
+
+/**
+ * Size of a whole graph, counted before it is built.
+ *
+ * The items of a clique are all present at one common date, so a subset of them fits into a bin exactly when
+ * its sizes sum up to at most the capacity, and the combinations of a clique are counted by a dynamic program
+ * over the sums of sizes instead of being enumerated. An arc joins two combinations of consecutive cliques that
+ * take the same shared items: with N(w) the subsets of the shared items of total size w, and F(r) the subsets of
+ * the items of one clique only of total size at most r, the two cliques have sum over w of
+ * N(w) Fcurrent(C-w) Fnext(C-w) arcs. Counts are exact for the graph without dominance pruning (which can only
+ * remove vertices and arcs), up to the precision of a double beyond 2^53.
+ * Each dynamic program takes O(items x min(capacity, total size)) steps
+ */
+class GraphEstimate {
+public:
+    /**
+     * Memory needed to build a graph, in multiples of its arrays: the columns of the build and the assembled arrays
+     * are alive together
+     */
+    static constexpr double FOOTPRINT_RATIO = 2.5;
+
+    vector<CliqueEstimate> _cliques;
+    double _nbVertices;         ///< start and sink included
+    double _nbArcs;             ///< arcs leaving the start included
+    double _nbVertexItems;
+    double _nbArcItems;
+    double _maxNbCombosClique;
+
+    GraphEstimate() : _nbVertices(0), _nbArcs(0), _nbVertexItems(0), _nbArcItems(0), _maxNbCombosClique(0) {}
+
+    int getNbColumns() const { return _cliques.size() + 2; }
+
+    /**
+     * Bytes of the arrays of the LayeredGraph
+     */
+    double getGraphBytes() const;
+
+    /**
+     * Memory needed to build the graph, in KB
+     */
+    double getFootprintKb() const { return FOOTPRINT_RATIO * getGraphBytes() / 1024; }
+};
+
+/**
+ * Estimates the graph of the given cliques, clique members being indexes into sizes, each one standing for
+ * multiplicities[i] interchangeable items of size sizes[i] (1 for items, see ItemTypes for types)
+ */
+GraphEstimate estimateGraph(const vector<int> & sizes, const vector<int> & multiplicities, int capacity, const CliqueSet & cliques);
+
+/**
+ * Estimates the normal or the reduced graph of data, right after its cliques are computed
+ */
+GraphEstimate estimateGraph(TemporalBPData & data, bool reduced);
+
+/**
+ * Estimates the aggregated graph of data (see TBPaggregation.hpp)
+ */
+GraphEstimate estimateAggregatedGraph(const TemporalBPData & data);
+
+/**
+ * Graph that can be built for an instance under a memory budget
+ */
+enum GraphChoice {
+    GRAPH_NORMAL,
+    GRAPH_REDUCED,
+    GRAPH_AGGREGATED,   ///< only solved greedily, see trySolveAggregated
+    GRAPH_NONE,         ///< no graph fits, the build is refused
+    GRAPH_EVENTS        ///< requested, never picked under a budget: see buildEventGraph
+};
+
+string getGraphChoiceName(GraphChoice choice);
+
+/**
+ * Picks the first graph whose footprint fits budgetKb, among the requested one (reduced or not), the reduced graph
+ * and the aggregated graph, without allocating any of them. Any graph fits a budget of 0.
+ * The estimate of the graph picked (the last one tried for GRAPH_NONE) goes to estimate if it is not null
+ */
+GraphChoice chooseGraph(TemporalBPData & data, bool reduced, long budgetKb, GraphEstimate * estimate = nullptr);
@@ -0,0 +1,49 @@
+//
+// Created by lhirwashema on 2022-08-06.
+//
+
+#pragma once
+
+#include "TBPdata.hpp"
+#include "TBPgraph.hpp"
+
+/**
+ * Entry or exit of an item, the layers of the event graph
+ */
+class ItemEvent {
+public:
+    int _date;
+    bool _entry;
+    int _item;
+
+    ItemEvent(int date, bool entry, int item) : _date(date), _entry(entry), _item(item) {}
+};
+
+/**
+ * Events of the items in chronological order. At the same date, exits come before entries, as an item
+ * leaving at the date another one enters does not meet it, and items enter in the order of their IDs.
+ * An item of length 0 leaves right after its own entry, so it meets the items entering before it at that date
+ * and none entering after it, as in isFeasible
+ */
+vector<ItemEvent> getItemEvents(const vector<Item> & items);
+
+/**
+ * Graph with one layer per event of the items instead of one column per clique.
+ *
+ * A vertex is a bin at one moment: the ongoing items it holds, its load being their total size. Column 0 holds
+ * the empty bin before the first event, and column k holds the bins after event k, so the last column holds the
+ * empty bin once every item left, which is the sink. The arcs are elementary transitions:
+ *  - the entry of an item either skips it (same bin, no new item) or packs it (new item, when the load allows it);
+ *  - the exit of an item drops it from the bins holding it, the bins with and without it merging.
+ * Every vertex has at most two arcs, against all the compatible pairs of combinations of two cliques in buildGraph,
+ * but the columns are the feasible subsets of the ongoing items after each event, twice as many columns as items.
+ * The graph has the view of LayeredGraph, the columns between the start and the sink standing for events instead
+ * of cliques, so TBPSolver runs on it unchanged: paths pack every item with one arc, and the items of a column
+ * are those present after its event
+ */
+LayeredGraph buildEventGraph(const vector<Item> & items, int capacity, int * maxNbVerticesColumn = nullptr);
+
+/**
+ * Builds the event graph of data, the largest column going to data._maxNbCombosClique
+ */
+LayeredGraph buildEventGraph(TemporalBPData & data);
@@ -0,0 +1,157 @@
+//
+// Created by lhirwashema on 2022-08-05.
+//
+
+#pragma once
+
+#include "TBPgraph.hpp"
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+/**
+ * Output file written through one fixed buffer, handed to the system in whole chunks.
+ * Integers are formatted in place, so nothing is allocated per line and nothing is flushed before the buffer is full
+ */
+class ChunkedWriter {
+public:
+    static const size_t DEFAULT_CHUNK_SIZE = 1 << 22;
+
+    explicit ChunkedWriter(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+    ~ChunkedWriter();
+
+    ChunkedWriter(const ChunkedWriter &) = delete;
+    ChunkedWriter & operator=(const ChunkedWriter &) = delete;
+
+    /**
+     * Creates or truncates the file
+     */
+    bool open(const string & fileName, string & error);
+
+    /**
+     * Writes what is left in the buffer and closes the file
+     */
+    bool close(string & error);
+
+    void putChar(char c) { reserve(1); _buffer[_used++] = c; }
+    void putText(const char * text);
+    void putInt(long value);
+
+    /**
+     * Writes size raw bytes, in the byte order of the machine for integers
+     */
+    void putBytes(const void * data, size_t size);
+    void putInt32(int32_t value) { putBytes(&value, sizeof(value)); }
+
+    /**
+     * Bytes written so far, the buffer included: the offset of the next byte in the file
+     */
+    uint64_t getOffset() const { return _flushed + _used; }
+
+    /**
+     * Overwrites bytes already written at offset, once the buffer is flushed
+     */
+    bool patch(uint64_t offset, const void * data, size_t size);
+
+    bool isOk() const { return _fd >= 0 && _ok; }
+
+private:
+    int _fd;
+    bool _ok;
+    string _fileName;
+    char * _buffer;
+    size_t _chunkSize;
+    size_t _used;
+    uint64_t _flushed;
+
+    void reserve(size_t size) { if (_used + size > _chunkSize) flush(); }
+    void flush();
+};
+
+/**
+ * Formats of the graph export
+ */
+enum ExportFormat {
+    EXPORT_DIMACS,   ///< DIMACS min-cost flow, text
+    EXPORT_BINARY    ///< edge list of 32-bit integers, see EdgeListHeader
+};
+
+/**
+ * Header of the binary edge list. It is followed by one record per arc, in the order of the arcs of the graph:
+ * tail ID, head ID, number of new items, then the new items, all as 32-bit integers in the byte order of the machine.
+ * Vertex IDs are the ones of LayeredGraph, 0 for the start and getNbVertices()-1 for the sink
+ */
+class EdgeListHeader {
+public:
+    char _magic[4];          ///< "TBPE"
+    uint32_t _version;
+    uint64_t _nbVertices;
+    uint64_t _nbArcs;
+    uint64_t _nbLabels;      ///< new items of all arcs
+    uint64_t _nbItems;       ///< largest item + 1
+};
+
+/**
+ * Writes a layered graph as a flow network, column after column, so that a graph streamed by StreamingGraphBuilder
+ * never has to be assembled.
+ *
+ * In DIMACS format, a bin is one unit of flow from the start (node 1) to the sink, the arcs leaving the start cost one
+ * and every arc has the capacity of the supply, the number of items by default. An extra arc from the start to the
+ * sink, of cost 0, carries the unused supply, so a minimum cost flow counts the bins. The covering of the items is
+ * no flow constraint: with labels, each arc taking new items is followed by a comment line "c l item item ...",
+ * which DIMACS readers skip. The counts of the problem line are only known at the end: the header is written
+ * with padded numbers and overwritten by close
+ */
+class GraphExporter {
+public:
+    GraphExporter(ExportFormat format, bool labels = true, long supply = 0, size_t chunkSize = ChunkedWriter::DEFAULT_CHUNK_SIZE);
+
+    bool open(const string & fileName, string & error);
+
+    /**
+     * Writes the next column, its arcs pointing to rows of the column written next (as for LayeredGraph::appendColumn).
+     * The first column is the start and the last one is the sink
+     */
+    void writeColumn(const GraphColumn & column);
+
+    /**
+     * Writes every column of a built graph, into an exporter that has written nothing else
+     */
+    void writeGraph(const LayeredGraph & graph);
+
+    /**
+     * Completes the header and closes the file
+     */
+    bool close(string & error);
+
+    int getNbColumns() const { return _nbColumns; }
+    uint64_t getNbVertices() const { return _nbVertices; }
+    uint64_t getNbArcs() const { return _nbArcs; }
+    uint64_t getNbBytes() const { return _writer.getOffset(); }
+
+private:
+    ExportFormat _format;
+    bool _labels;
+    long _supply;
+    ChunkedWriter _writer;
+    int _nbColumns;
+    uint64_t _nbVertices;   ///< vertices of the columns written so far, the ID of the first vertex of the next column
+    uint64_t _nbArcs;
+    uint64_t _nbLabels;
+    int _nbItems;
+    uint64_t _headerOffset;   ///< counts of the header, overwritten by close
+
+    void writeHeader(bool final);
+    void writeArc(uint64_t tail, uint64_t head, const int * itemsBegin, const int * itemsEnd);
+};
+
+/**
+ * Writes a built graph in one call. Returns false with an error if the file cannot be written
+ */
+bool exportGraph(const LayeredGraph & graph, const string & fileName, ExportFormat format, bool labels, string & error);
+
+/**
+ * Extension of the files of a format: .min for DIMACS, .tbpe for the binary edge list
+ */
+string getExportExtension(ExportFormat format);
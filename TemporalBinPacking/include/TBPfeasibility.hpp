@@ -0,0 +1,76 @@
+//
+// Created by lhirwashema on 2022-07-25.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+class Item;
+
+/**
+ * Capacity check of many subsets of one clique at once.
+ *
+ * A subset is a bitmask over the clique, as in FeasibleCombos: bit k stands for the k-th item in entry order,
+ * on as many 64-bit words as the clique needs. The clique is turned once into a list of events in
+ * structure-of-arrays layout: the entry of every item, preceded by the exits of the items that leave before it.
+ * The load of a subset is the sum of the deltas of the events of its items, and it has to stay within the capacity
+ * after every entry, which gives exactly the answer of TemporalBPData::isFeasible.
+ *
+ * Batches are checked four subsets at a time with AVX2 when the processor has it (checked at run time,
+ * "cmake -DTBP_SIMD=OFF .." removes that code), one subset at a time otherwise.
+ */
+class FeasibilityKernel {
+public:
+    FeasibilityKernel(const vector<Item> & items, int capacity, const vector<int> & clique);
+    FeasibilityKernel(const vector<const Item *> & cliqueItems, int capacity);
+
+    int getNbItems() const { return _items.size(); }
+    int getNbWords() const { return _nbWords; }
+
+    /**
+     * Items of the clique in entry order, bit k of a mask standing for _items[k]
+     */
+    const vector<int> & getItems() const { return _items; }
+
+    /**
+     * Mask of a selection of items of the clique, the ids of other items being ignored
+     */
+    vector<uint64_t> getMask(const vector<int> & selection) const;
+
+    /**
+     * Determines whether the subset of the clique given by mask (getNbWords() words) fits into one bin
+     */
+    bool isFeasible(const uint64_t * mask) const;
+
+    /**
+     * Checks nbMasks subsets stored one after the other, getNbWords() words each,
+     * and sets feasible[m] to 1 if the m-th fits into one bin, 0 otherwise. Returns the number of feasible subsets
+     */
+    int checkBatch(const uint64_t * masks, int nbMasks, char * feasible) const;
+
+    /**
+     * Same as checkBatch without the vectorized path, for comparison
+     */
+    int checkBatchScalar(const uint64_t * masks, int nbMasks, char * feasible) const;
+
+    /**
+     * Determines whether checkBatch uses AVX2 on this machine
+     */
+    static bool hasSimd();
+
+private:
+    int _capacity;
+    int _nbWords;
+    vector<int> _items;
+    vector<int> _eventWords;        ///< word of the mask holding the item of each event
+    vector<uint64_t> _eventBits;    ///< bit of the item within that word
+    vector<int64_t> _eventDeltas;   ///< size of the item, negative for an exit
+    vector<char> _eventChecks;      ///< 1 for an entry, after which the load is checked
+
+    void init(vector<const Item *> sorted);
+    int checkBatchSimd(const uint64_t * masks, int nbMasks, char * feasible) const;
+};
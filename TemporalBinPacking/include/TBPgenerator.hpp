@@ -0,0 +1,70 @@
+//
+// Created by lhirwashema on 2022-07-04.
+//
+
+#pragma once
+
+#include "TBPdata.hpp"
+#include <ostream>
+#include <string>
+
+/**
+ * Shape of a random integer drawn in an interval [lo, hi]
+ */
+enum Distribution {
+    UNIFORM,       ///< every value equally likely
+    NORMAL,        ///< centered, standard deviation (hi-lo)/6, clamped to the interval
+    EXPONENTIAL,   ///< lo plus an exponential of mean (hi-lo)/4, clamped: mostly short, a few long
+    BIMODAL        ///< half in the lowest quarter, half in the highest quarter of the interval
+};
+
+/**
+ * Reads a distribution from its name in lower case, returns false if the name is unknown
+ */
+bool parseDistribution(const string & name, Distribution & distribution);
+
+string getDistributionName(Distribution distribution);
+
+/**
+ * Parameters of a random TBP instance
+ */
+class GeneratorParams {
+public:
+    int _nbItems;      ///< number of items
+    int _capacity;     ///< capacity of a bin
+    int _minSize;      ///< sizes are drawn in [_minSize, _maxSize]
+    int _maxSize;
+    Distribution _sizeDistribution;
+    int _horizon;      ///< entry dates are drawn uniformly in [0, _horizon)
+    int _minLength;    ///< time spent in the bin is drawn in [_minLength, _maxLength]
+    int _maxLength;
+    Distribution _lengthDistribution;
+    double _overlap;   ///< if positive, average number of items present at a time, which sets the horizon
+
+    GeneratorParams() :
+        _nbItems(100),
+        _capacity(100),
+        _minSize(1),
+        _maxSize(50),
+        _sizeDistribution(UNIFORM),
+        _horizon(1000),
+        _minLength(10),
+        _maxLength(100),
+        _lengthDistribution(UNIFORM),
+        _overlap(0){}
+
+    /**
+     * Horizon of the entry dates, derived from _overlap when it is set
+     */
+    int getHorizon() const;
+};
+
+/**
+ * Draws a list of items from the given parameters, the same seed always gives the same instance
+ */
+vector<Item> generateItems(const GeneratorParams & params, unsigned int seed);
+
+/**
+ * Writes an instance in the format of the files of the data folder
+ */
+void writeInstance(std::ostream & out, int capacity, const vector<Item> & items);
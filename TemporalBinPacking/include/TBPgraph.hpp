@@ -0,0 +1,284 @@
+//
+// Created by lhirwashema on 2022-07-08.
+//
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "TBParena.hpp"
+
+using namespace std;
+
+/**
+ * Vertices and arcs of one column of the graph, as they are produced by the builder.
+ * Arcs point to rows of the next column; LayeredGraph::appendColumn turns them into vertex IDs.
+ * The buffers come from the arena of the build if there is one, the column then lives no longer than the arena
+ */
+class GraphColumn {
+public:
+    ArenaIntVector _itemOffsets;      ///< items of vertex r are _items[_itemOffsets[r]] ... _items[_itemOffsets[r+1]-1]
+    ArenaIntVector _items;
+    ArenaIntVector _arcOffsets;       ///< arcs of vertex r are _arcOffsets[r] ... _arcOffsets[r+1]-1
+    ArenaIntVector _arcTargets;       ///< row of the successor in the next column
+    ArenaIntVector _arcItemOffsets;   ///< new items of arc a are _arcItems[_arcItemOffsets[a]] ... _arcItems[_arcItemOffsets[a+1]-1]
+    ArenaIntVector _arcItems;
+
+    GraphColumn(MonotonicArena * arena = nullptr) :
+        _itemOffsets(1, 0, arena),
+        _items(arena),
+        _arcOffsets(1, 0, arena),
+        _arcTargets(arena),
+        _arcItemOffsets(1, 0, arena),
+        _arcItems(arena) {}
+
+    int getNbVertices() const { return _itemOffsets.size() - 1; }
+    int getNbArcs() const { return _arcTargets.size(); }
+
+    /**
+     * Adds an arc to the vertex being built, its new items are pushed to _arcItems beforehand
+     */
+    void closeArc(int targetRow) {
+        _arcTargets.push_back(targetRow);
+        _arcItemOffsets.push_back(_arcItems.size());
+    }
+
+    /**
+     * Removes every arc and keeps the vertices, before linking the column again
+     */
+    void clearArcs() {
+        _arcOffsets.assign(1, 0);
+        _arcTargets.clear();
+        _arcItemOffsets.assign(1, 0);
+        _arcItems.clear();
+    }
+
+    /**
+     * Closes the vertex being built, its items and arcs are the ones pushed since the last call
+     */
+    void closeVertex() {
+        _itemOffsets.push_back(_items.size());
+        _arcOffsets.push_back(_arcTargets.size());
+    }
+};
+
+/**
+ * Read-only view of an arc of a LayeredGraph.
+ * The successor is given by its ID and by its position, the successor column being the one after the vertex
+ */
+class ArcView {
+public:
+    ArcView(int successorId, int successorColumn, int successorRow, const int * newItemsBegin, const int * newItemsEnd) :
+        _successorId(successorId),
+        _successorColumn(successorColumn),
+        _successorRow(successorRow),
+        _newItemsBegin(newItemsBegin),
+        _newItemsEnd(newItemsEnd){}
+
+    int getSuccessorId() const { return _successorId; }
+    int getSuccessorColumn() const { return _successorColumn; }
+    int getSuccessorRow() const { return _successorRow; }
+    int getNbNewItems() const { return _newItemsEnd - _newItemsBegin; }
+    const int * newItemsBegin() const { return _newItemsBegin; }
+    const int * newItemsEnd() const { return _newItemsEnd; }
+    vector<int> getNewItems() const { return vector<int>(_newItemsBegin, _newItemsEnd); }
+
+private:
+    int _successorId;
+    int _successorColumn;
+    int _successorRow;
+    const int * _newItemsBegin;
+    const int * _newItemsEnd;
+};
+
+class LayeredGraph;
+
+/**
+ * Read-only view of a vertex of a LayeredGraph
+ */
+class VertexView {
+public:
+    VertexView(const LayeredGraph & graph, int id) : _graph(&graph), _id(id) {}
+
+    int getId() const { return _id; }
+    int getColumn() const;
+    int getRow() const;
+    int getNbItems() const;
+    const int * itemsBegin() const;
+    const int * itemsEnd() const;
+    vector<int> getItems() const { return vector<int>(itemsBegin(), itemsEnd()); }
+
+    int getNbArcs() const;
+    ArcView getArc(int a) const;
+
+private:
+    const LayeredGraph * _graph;
+    int _id;
+};
+
+/**
+ * Read-only range of ints of a LayeredGraph, stored in its own vectors or in a mapped cache file
+ */
+class IntSpan {
+public:
+    IntSpan() : _data(nullptr), _size(0) {}
+    IntSpan(const int * data, size_t size) : _data(data), _size(size) {}
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    const int * data() const { return _data; }
+    const int * begin() const { return _data; }
+    const int * end() const { return _data + _size; }
+    const int & operator[](size_t i) const { return _data[i]; }
+    const int & back() const { return _data[_size - 1]; }
+
+private:
+    const int * _data;
+    size_t _size;
+};
+
+/**
+ * Arrays of a LayeredGraph, in the order of the cache files
+ */
+enum GraphArray {
+    COLUMN_OFFSETS,
+    VERTEX_ITEM_OFFSETS,
+    VERTEX_ITEMS,
+    ARC_OFFSETS,
+    ARC_SUCCESSORS,
+    ARC_ITEM_OFFSETS,
+    ARC_ITEMS,
+    NB_GRAPH_ARRAYS
+};
+
+/**
+ * Layered graph of the TBP problem in CSR layout.
+ *
+ * Column 0 holds the start vertex, the last column holds the sink and every column in between
+ * corresponds to a clique. Vertex IDs follow the chronological order of columns, then the order of rows,
+ * so the vertices of column c are the IDs _columnOffsets[c] ... _columnOffsets[c+1]-1.
+ * The column of every vertex is kept as well, so an ID is turned into a (column, row) position in constant time.
+ * Vertex items and arc new items are ranges of two item pools, so nothing is allocated per vertex or per arc.
+ *
+ * The arrays are read through spans: they point to vectors owned by the graph when it is built,
+ * or directly into a mapped file when it comes from the cache (see TBPcache.hpp).
+ */
+class LayeredGraph {
+public:
+    IntSpan _columnOffsets;       ///< size getNbColumns()+1
+    IntSpan _vertexItemOffsets;   ///< size getNbVertices()+1, into _vertexItems
+    IntSpan _vertexItems;         ///< items of all vertices, one after the other
+    IntSpan _arcOffsets;          ///< size getNbVertices()+1, into the arc arrays
+    IntSpan _arcSuccessors;       ///< ID of the successor of each arc
+    IntSpan _arcItemOffsets;      ///< size getNbArcs()+1, into _arcItems
+    IntSpan _arcItems;            ///< new items of all arcs, one after the other
+
+    LayeredGraph();
+    LayeredGraph(const LayeredGraph & graph);
+    LayeredGraph(LayeredGraph && graph);
+    LayeredGraph & operator=(LayeredGraph graph);
+
+    int getNbColumns() const { return _columnOffsets.size() - 1; }
+    int getColumnSize(int column) const { return _columnOffsets[column + 1] - _columnOffsets[column]; }
+    int getNbVertices() const { return _vertexItemOffsets.size() - 1; }
+    int getNbArcs() const { return _arcSuccessors.size(); }
+
+    VertexView getVertex(int column, int row) const { return VertexView(*this, _columnOffsets[column] + row); }
+    VertexView getVertexById(int id) const { return VertexView(*this, id); }
+
+    int getColumnOf(int id) const { return _vertexColumns[id]; }
+    int getRowOf(int id) const { return id - _columnOffsets[_vertexColumns[id]]; }
+
+    /**
+     * Appends a column after the current last one, its arcs point to rows of the column appended next
+     */
+    void appendColumn(const GraphColumn & column);
+
+    /**
+     * Appends columns given in chronological order
+     */
+    void assemble(const vector<GraphColumn> & columns);
+    void assemble(const GraphColumn * columns, int nbColumns);
+
+    /**
+     * Replaces columns [first, oldLast) by nbColumns columns, the arcs of the last one pointing to rows of column oldLast.
+     * The vertices of the following columns are renumbered, which shifts the arrays once.
+     * The arcs of column first-1 have to stay valid, its successors keeping their rows
+     */
+    void replaceColumns(int first, int oldLast, const GraphColumn * columns, int nbColumns);
+
+    /**
+     * Replaces every item i of the vertices and arcs of a column by itemMap[i]
+     */
+    void renumberItems(int column, const vector<int> & itemMap);
+
+    const IntSpan & getArray(GraphArray array) const { return *getSpans()[array]; }
+
+    /**
+     * Turns the graph into a view of arrays stored in a mapping, which lives as long as the graph or its copies.
+     * Appending a column afterwards copies the arrays into vectors first
+     */
+    void mapArrays(const shared_ptr<const void> & mapping, const vector<IntSpan> & arrays);
+
+    bool isMapped() const { return _mapping != nullptr; }
+
+    void swap(LayeredGraph & graph);
+
+private:
+    vector<int> _owned[NB_GRAPH_ARRAYS];   ///< arrays of a graph built in memory
+    shared_ptr<const void> _mapping;       ///< mapped file of a graph loaded from the cache
+    vector<int> _vertexColumns;            ///< column of each vertex, derived from _columnOffsets and never cached
+
+    array<IntSpan *, NB_GRAPH_ARRAYS> getSpans();
+    array<const IntSpan *, NB_GRAPH_ARRAYS> getSpans() const;
+
+    /**
+     * Points every span to the vector of the same array
+     */
+    void bindOwned();
+
+    /**
+     * Copies mapped arrays into vectors and points the spans to them, before a change
+     */
+    void makeOwned();
+
+    /**
+     * Sets _vertexColumns from _columnOffsets
+     */
+    void indexVertices();
+};
+
+inline int VertexView::getColumn() const {
+    return _graph->getColumnOf(_id);
+}
+
+inline int VertexView::getRow() const {
+    return _graph->getRowOf(_id);
+}
+
+inline int VertexView::getNbItems() const {
+    return _graph->_vertexItemOffsets[_id + 1] - _graph->_vertexItemOffsets[_id];
+}
+
+inline const int * VertexView::itemsBegin() const {
+    return _graph->_vertexItems.data() + _graph->_vertexItemOffsets[_id];
+}
+
+inline const int * VertexView::itemsEnd() const {
+    return _graph->_vertexItems.data() + _graph->_vertexItemOffsets[_id + 1];
+}
+
+inline int VertexView::getNbArcs() const {
+    return _graph->_arcOffsets[_id + 1] - _graph->_arcOffsets[_id];
+}
+
+inline ArcView VertexView::getArc(int a) const {
+    int arc = _graph->_arcOffsets[_id] + a;
+    const int * pool = _graph->_arcItems.data();
+    const int successor = _graph->_arcSuccessors[arc];
+    return ArcView(successor, _graph->getColumnOf(successor), _graph->getRowOf(successor),
+                   pool + _graph->_arcItemOffsets[arc],
+                   pool + _graph->_arcItemOffsets[arc + 1]);
+}
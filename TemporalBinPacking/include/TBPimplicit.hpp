@@ -0,0 +1,120 @@
+//
+// Created by lhirwashema on 2022-08-02.
+//
+
+#pragma once
+
+#include "TBPcliques.hpp"
+#include "TBPdata.hpp"
+#include "TBPfeasibility.hpp"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * Vertex of an ImplicitGraph: a feasible combination of a clique, as a bitmask over the items of the clique
+ * (bit k standing for its k-th item in entry order). The start has clique -1 and the sink clique getNbCliques()
+ */
+class ImplicitVertex {
+public:
+    int _clique;
+    vector<uint64_t> _mask;
+
+    ImplicitVertex() : _clique(-1) {}
+    ImplicitVertex(int clique, const vector<uint64_t> & mask) : _clique(clique), _mask(mask) {}
+
+    bool operator==(const ImplicitVertex & vertex) const { return _clique == vertex._clique && _mask == vertex._mask; }
+};
+
+class ImplicitVertexHash {
+public:
+    size_t operator()(const ImplicitVertex & vertex) const {
+        uint64_t hash = vertex._clique * 0x9E3779B97F4A7C15ULL;
+        for (const auto & word : vertex._mask)
+            hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+        return hash ^ (hash >> 31);
+    }
+};
+
+/**
+ * Successors of a vertex of an ImplicitGraph, stored flat: successor s has the mask
+ * _masks[s*_nbWords] ... _masks[(s+1)*_nbWords-1] over the next clique and brings in the items
+ * _newItems[_newItemOffsets[s]] ... _newItems[_newItemOffsets[s+1]-1]
+ */
+class SuccessorList {
+public:
+    int _clique;                  ///< clique of the successors
+    int _nbWords;
+    vector<uint64_t> _masks;
+    vector<int> _newItemOffsets;
+    vector<int> _newItems;
+
+    SuccessorList() : _clique(0), _nbWords(1), _newItemOffsets(1, 0) {}
+
+    int size() const { return _newItemOffsets.size() - 1; }
+    ImplicitVertex getSuccessor(int s) const {
+        return ImplicitVertex(_clique, vector<uint64_t>(_masks.begin() + (size_t)s * _nbWords, _masks.begin() + (size_t)(s + 1) * _nbWords));
+    }
+    vector<int> getNewItems(int s) const {
+        return vector<int>(_newItems.begin() + _newItemOffsets[s], _newItems.begin() + _newItemOffsets[s + 1]);
+    }
+};
+
+/**
+ * Layered graph of the TBP problem whose vertices and arcs are only generated when a traversal asks for them.
+ *
+ * It describes the same graph as TemporalBPData::buildGraph (or buildReducedGraph with the reduced cliques),
+ * without dominance pruning: the successors of a combination X of clique a are the feasible combinations of
+ * clique a+1 that agree with X on the items both cliques share. They are generated by adding the items of
+ * clique a+1 that clique a does not hold, one at a time in entry order, to the shared items of X; feasibility
+ * being hereditary, a branch stops at the first item that does not fit.
+ *
+ * Only the cliques and one FeasibilityKernel per clique are kept for the whole instance. Successor lists are
+ * memoized in a cache holding the most recently used ones, so memory and time follow the vertices visited
+ * instead of the size of the whole graph. The graph is not thread-safe
+ */
+class ImplicitGraph {
+public:
+    ImplicitGraph(const vector<Item> & items, int capacity, const CliqueSet & cliques, size_t cacheSize = 1 << 16);
+
+    /**
+     * Graph of the maximum (or reduced) cliques of data
+     */
+    ImplicitGraph(TemporalBPData & data, bool reduced, size_t cacheSize = 1 << 16);
+
+    int getNbCliques() const { return _cliques.getNbCliques(); }
+    ImplicitVertex getStart() const { return ImplicitVertex(-1, vector<uint64_t>(1, 0)); }
+    ImplicitVertex getSink() const { return ImplicitVertex(getNbCliques(), vector<uint64_t>(1, 0)); }
+    bool isSink(const ImplicitVertex & vertex) const { return vertex._clique == getNbCliques(); }
+
+    /**
+     * Items of a vertex, by increasing ID
+     */
+    vector<int> getItems(const ImplicitVertex & vertex) const;
+
+    /**
+     * Successors of a vertex, from the cache or generated. The list stays valid as long as it is held,
+     * even once evicted from the cache
+     */
+    shared_ptr<const SuccessorList> getSuccessors(const ImplicitVertex & vertex);
+
+    long getNbGenerated() const { return _nbGenerated; }   ///< successor lists generated, cache misses
+    long getNbCacheHits() const { return _nbCacheHits; }
+    size_t getCacheSize() const { return _cache.size(); }
+
+private:
+    int _capacity;
+    CliqueSet _cliques;
+    vector<FeasibilityKernel> _kernels;   ///< capacity check of each clique
+    size_t _maxCacheSize;
+    long _nbGenerated;
+    long _nbCacheHits;
+
+    typedef pair<ImplicitVertex, shared_ptr<const SuccessorList>> CacheEntry;
+    list<CacheEntry> _recent;             ///< most recently used first
+    unordered_map<ImplicitVertex, list<CacheEntry>::iterator, ImplicitVertexHash> _cache;
+
+    void init(const vector<Item> & items);
+    shared_ptr<const SuccessorList> generate(const ImplicitVertex & vertex) const;
+};
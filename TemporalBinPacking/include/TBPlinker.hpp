@@ -0,0 +1,26 @@
+//
+// Created by lhirwashema on 2022-07-13.
+//
+
+#pragma once
+
+#include "TBPcombos.hpp"
+#include "TBPgraph.hpp"
+
+/**
+ * Creates the arcs from the vertices of a column towards the vertices of the next column.
+ *
+ * A vertex v of the next column is a successor of u exactly when both agree on the items shared by
+ * the two cliques, so every vertex is keyed by its projection onto the shared items (a bitmask).
+ * Vertices of the next column are sorted by key once, and each u finds its successors with a binary
+ * search in time proportional to the number of arcs it gets. The new items of an arc are the items
+ * of v outside the shared ones, which only depend on v and are computed once per vertex.
+ *
+ * Arcs come in increasing row order of the successors, as with the exhaustive scan.
+ */
+void linkIndexed(const FeasibleCombos & current, const FeasibleCombos & next, GraphColumn & column);
+
+/**
+ * Number of arcs linkIndexed would create between the two columns, without creating them
+ */
+long countLinks(const FeasibleCombos & current, const FeasibleCombos & next);
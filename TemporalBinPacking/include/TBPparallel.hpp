@@ -0,0 +1,24 @@
+//
+// Created by lhirwashema on 2022-07-11.
+//
+
+#pragma once
+
+#include <functional>
+
+using namespace std;
+
+/**
+ * Number of workers matching the hardware threads of the machine, at least 1
+ */
+int getHardwareNbWorkers();
+
+/**
+ * Runs task(i) for every i in [0, nbTasks) on nbWorkers threads, the calling thread being one of them.
+ *
+ * Each worker starts with a contiguous share of the indexes. Once its share is exhausted,
+ * it steals the upper half of what remains in the share of another worker, so uneven tasks
+ * (such as cliques of very different widths) keep every worker busy.
+ * With a single worker the tasks run in order on the calling thread.
+ */
+void parallelFor(int nbTasks, int nbWorkers, const function<void(int)> & task);
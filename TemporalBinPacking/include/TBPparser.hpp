@@ -0,0 +1,51 @@
+//
+// Created by lhirwashema on 2022-07-19.
+//
+
+#pragma once
+
+#include "TBPdata.hpp"
+#include <string>
+
+/**
+ * Content of an instance file, items in the order of the file with their original IDs
+ */
+class TBPInstance {
+public:
+    string _fileName;
+    int _capacity;           ///< capacity of a bin
+    vector<Item> _items;
+    string _error;           ///< empty when the file was read successfully
+
+    TBPInstance() : _capacity(0) {}
+
+    bool isValid() const { return _error.empty(); }
+};
+
+/**
+ * Decodes an instance from a buffer: a header line "nbItems capacity 0 0", then one line
+ * "id entry exit size" per item. Integers are decoded in place, without any copy of the buffer.
+ * The header and the number of item lines are checked, as well as entry <= exit and 0 <= size <= capacity.
+ * Returns false and fills error, with the line number, if the buffer does not follow the format
+ */
+bool parseInstanceBuffer(const char * begin, const char * end, int & capacity, vector<Item> & items, string & error);
+
+/**
+ * Reads an instance file through a memory mapping of the whole file.
+ * Failures are reported in the _error field of the result
+ */
+TBPInstance parseInstance(const string & fileName);
+
+/**
+ * Lists the instance files designated by a path:
+ *  - a directory gives its regular files ending with .txt, by name;
+ *  - any other file is a manifest with one instance path per line, relative paths being taken from
+ *    the folder of the manifest. Empty lines and lines starting with '#' are skipped.
+ * Returns false and fills error if the path cannot be read
+ */
+bool listInstances(const string & path, vector<string> & fileNames, string & error);
+
+/**
+ * Parses instance files concurrently on nbWorkers threads, results come in the order of fileNames
+ */
+vector<TBPInstance> loadInstances(const vector<string> & fileNames, int nbWorkers);
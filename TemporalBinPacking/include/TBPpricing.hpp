@@ -0,0 +1,94 @@
+//
+// Created by lhirwashema on 2022-08-01.
+//
+
+#pragma once
+
+#include "TBPgraph.hpp"
+#include <vector>
+
+using namespace std;
+
+/**
+ * Path from the start to the sink, that is a bin, found by a TBPPricer
+ */
+class PricingPath {
+public:
+    double _weight;          ///< sum of the duals of its items
+    double _reducedCost;     ///< cost of a bin minus _weight
+    vector<int> _vertices;   ///< IDs from the start to the sink
+    vector<int> _arcs;       ///< indexes of the arcs in the arrays of the graph, one fewer than the vertices
+    vector<int> _items;      ///< items of the bin, in the order they enter it
+
+    PricingPath() : _weight(0), _reducedCost(0) {}
+};
+
+/**
+ * Pricing of bins over a built LayeredGraph, for a column generation: a bin is a path from the start to the sink,
+ * and its reduced cost is the cost of a bin minus the duals of the items it holds.
+ *
+ * The weight of every arc, the sum of the duals of its new items, is kept in a flat array: setDuals fills it
+ * in one pass over the arc items, and setDual only updates the arcs that bring the item in.
+ * Vertex IDs following the chronological order of the columns, a path search is a single forward pass over
+ * the vertices and arcs. Arcs and vertices can be masked, for branching decisions, without changing the graph.
+ * The graph must outlive the pricer and stay unchanged
+ */
+class TBPPricer {
+public:
+    double _binCost;     ///< cost of a bin in the master problem
+
+    TBPPricer(const LayeredGraph & graph, int nbItems);
+
+    /**
+     * Sets the dual of every item, duals being indexed by item ID
+     */
+    void setDuals(const vector<double> & duals);
+
+    /**
+     * Changes the dual of one item
+     */
+    void setDual(int item, double dual);
+
+    double getDual(int item) const { return _duals[item]; }
+    double getArcWeight(int arc) const { return _arcWeights[arc]; }
+
+    /**
+     * Arcs that bring an item into a bin: a path holds the item if and only if it uses one of them,
+     * so masking them forbids the item
+     */
+    const int * itemArcsBegin(int item) const { return _itemArcs.data() + _itemArcOffsets[item]; }
+    const int * itemArcsEnd(int item) const { return _itemArcs.data() + _itemArcOffsets[item + 1]; }
+
+    void setArcMasked(int arc, bool masked) { _arcMasked[arc] = masked; }
+    void setVertexMasked(int vertex, bool masked) { _vertexMasked[vertex] = masked; }
+    bool isArcMasked(int arc) const { return _arcMasked[arc]; }
+    bool isVertexMasked(int vertex) const { return _vertexMasked[vertex]; }
+    void clearMasks();
+
+    /**
+     * Finds the path of least reduced cost avoiding the masked arcs and vertices.
+     * Returns false if every path is masked
+     */
+    bool findBestPath(PricingPath & path) const;
+
+    /**
+     * Finds the k distinct paths of least reduced cost, best first, keeping the k best labels of every vertex.
+     * Fewer paths are returned if the graph has fewer unmasked paths
+     */
+    vector<PricingPath> findBestPaths(int k) const;
+
+private:
+    const LayeredGraph & _graph;
+    vector<double> _duals;
+    vector<double> _arcWeights;
+    vector<int> _itemArcOffsets;   ///< arcs bringing item i in are _itemArcs[_itemArcOffsets[i]] ... _itemArcs[_itemArcOffsets[i+1]-1]
+    vector<int> _itemArcs;
+    vector<int> _arcSources;       ///< vertex of each arc, to walk paths back
+    vector<char> _arcMasked;
+    vector<char> _vertexMasked;
+
+    /**
+     * Fills a path from its arcs, given from the sink back to the start
+     */
+    void makePath(vector<int> & arcs, double weight, PricingPath & path) const;
+};
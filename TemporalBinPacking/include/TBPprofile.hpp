@@ -0,0 +1,129 @@
+//
+// Created by lhirwashema on 2022-07-22.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Instrumentation of the hot stages, enabled by the TBP_PROFILE definition (CMake option of the same name).
+ *
+ * Scoped timers and counters are named entries of the Profiler, looked up once per call site and then
+ * updated with relaxed atomic additions, so they stay cheap from several threads.
+ * Without TBP_PROFILE the macros expand to nothing and no code is left in the stages.
+ */
+#ifdef TBP_PROFILE
+#define TBP_PROFILE_CONCAT_(a, b) a##b
+#define TBP_PROFILE_CONCAT(a, b) TBP_PROFILE_CONCAT_(a, b)
+/// times the rest of the enclosing scope
+#define TBP_PROFILE_SCOPE(name) \
+    static ProfileEntry & TBP_PROFILE_CONCAT(tbpProfileEntry, __LINE__) = Profiler::getInstance().getEntry(name); \
+    ScopedTimer TBP_PROFILE_CONCAT(tbpProfileTimer, __LINE__)(TBP_PROFILE_CONCAT(tbpProfileEntry, __LINE__))
+/// adds n to a counter
+#define TBP_PROFILE_COUNT(name, n) \
+    do { \
+        static ProfileEntry & tbpProfileEntry = Profiler::getInstance().getEntry(name); \
+        tbpProfileEntry.add(n); \
+    } while (0)
+/// code only compiled with the instrumentation
+#define TBP_PROFILE_ONLY(...) __VA_ARGS__
+#else
+#define TBP_PROFILE_SCOPE(name)
+#define TBP_PROFILE_COUNT(name, n) do {} while (0)
+#define TBP_PROFILE_ONLY(...)
+#endif
+
+/**
+ * Timer or counter: number of calls, total time in nanoseconds and total count
+ */
+class ProfileEntry {
+public:
+    string _name;
+    atomic<long> _nbCalls;
+    atomic<long> _totalNs;
+    atomic<long> _count;
+
+    ProfileEntry(const string & name) : _name(name), _nbCalls(0), _totalNs(0), _count(0) {}
+
+    void add(long n){
+        _nbCalls.fetch_add(1, memory_order_relaxed);
+        _count.fetch_add(n, memory_order_relaxed);
+    }
+
+    void addTime(long ns){
+        _nbCalls.fetch_add(1, memory_order_relaxed);
+        _totalNs.fetch_add(ns, memory_order_relaxed);
+    }
+};
+
+/**
+ * Registry of the entries of the process, in order of first use
+ */
+class Profiler {
+public:
+    static Profiler & getInstance();
+
+    /**
+     * Entry of the given name, created on first call. References stay valid for the life of the program
+     */
+    ProfileEntry & getEntry(const string & name);
+
+    /**
+     * Sets every entry back to zero
+     */
+    void reset();
+
+    void writeJson(ostream & out) const;
+    void writeCsv(ostream & out) const;
+
+private:
+    mutable mutex _mutex;
+    deque<ProfileEntry> _entries;   ///< a deque never moves its elements
+};
+
+class ScopedTimer {
+public:
+    ScopedTimer(ProfileEntry & entry) : _entry(entry), _start(chrono::steady_clock::now()) {}
+
+    ~ScopedTimer(){
+        _entry.addTime(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - _start).count());
+    }
+
+private:
+    ProfileEntry & _entry;
+    chrono::steady_clock::time_point _start;
+};
+
+/**
+ * Measures of one clique of the graph and of the links towards the next one.
+ * Bytes are those of the buffers of the combinations and of the graph column
+ */
+class ColumnStats {
+public:
+    int _width;            ///< items of the clique
+    long _nbCombos;        ///< feasible combinations, i.e. vertices of the column
+    long _nbChecks;        ///< capacity checks made by the enumeration
+    long _nbCandidates;    ///< pairs of vertices examined when linking to the next column
+    long _nbArcs;          ///< arcs towards the next column
+    double _combosMs;
+    double _linkMs;
+    long _bytes;
+
+    ColumnStats() : _width(0), _nbCombos(0), _nbChecks(0), _nbCandidates(0), _nbArcs(0),
+                    _combosMs(0), _linkMs(0), _bytes(0) {}
+};
+
+/**
+ * Writes one record per clique, the clique number included
+ */
+void writeColumnStatsJson(ostream & out, const vector<ColumnStats> & stats);
+void writeColumnStatsCsv(ostream & out, const vector<ColumnStats> & stats);
@@ -0,0 +1,93 @@
+//
+// Created by lhirwashema on 2022-07-15.
+//
+
+#pragma once
+
+#include "TBPdata.hpp"
+
+class TBPBounds;
+
+/**
+ * Packing of the items into bins
+ */
+class TBPSolution {
+public:
+    int _nbBins;              ///< number of bins used
+    int _lowerBound;          ///< best known lower bound on the number of bins
+    bool _optimal;            ///< true when _nbBins is proven minimal on the graph
+    vector<int> _binOfItem;   ///< bin of each item, indexed by item ID, -1 if the item appears in no path
+
+    TBPSolution() : _nbBins(0), _lowerBound(0), _optimal(false) {}
+};
+
+/**
+ * Solves the TBP problem over the layered graph of a TemporalBPData.
+ *
+ * A bin follows a path from the start to the sink, collecting the new items of its arcs,
+ * so a solution is a set of paths covering every item.
+ *  - the upper bound comes from a greedy decomposition: each path is the heaviest one in the not yet
+ *    covered items, found by one forward pass over the chronologically numbered vertices,
+ *    with flat arrays of arc weights updated as items get covered;
+ *  - the lower bound is the largest number of bins needed by the items of a single column;
+ *  - when both differ, a dynamic program over the columns closes the gap. Its states are the ways
+ *    of splitting the items carried from one column to the next into bins, and every column is
+ *    partitioned into vertices of the graph. The problem being NP-hard, the number of states is
+ *    bounded by _maxNbStates, beyond which the greedy solution is returned unproven.
+ *
+ * Columns of the reduced graph leave out some items, so its paths are a relaxation:
+ * a solution on that graph has to be checked with isValidSolution.
+ */
+class TBPSolver {
+public:
+    long _maxNbStates;    ///< budget of states of the dynamic program
+
+    TBPSolver(const TemporalBPData & data);
+
+    TBPSolution solve();
+
+    /**
+     * Solves starting from bounds computed without the graph (see TBPbounds.hpp): the first fit replaces the greedy
+     * solution when it uses fewer bins, and the lower bound of the cliques may prove a solution optimal sooner
+     */
+    TBPSolution solve(const TBPBounds & bounds);
+
+    /**
+     * Greedy decomposition of the graph into paths, one per bin
+     */
+    TBPSolution solveGreedy() const;
+
+    /**
+     * Largest number of bins needed by the items of one column, ceil(total size / capacity)
+     */
+    int computeLowerBound() const;
+
+    /**
+     * Runs the dynamic program looking for a solution with fewer bins than the given one.
+     * Returns true when it completed, the given solution being then optimal or replaced by an optimal one
+     */
+    bool improve(TBPSolution & solution) const;
+
+private:
+    const TemporalBPData & _data;
+    vector<vector<int>> _columnItems;    ///< items of each graph column, by increasing ID
+
+    /**
+     * Runs the dynamic program unless the solution already meets the lower bound. The lower bound is never lowered:
+     * a solution with fewer bins, found on a relaxation, is not optimal
+     */
+    TBPSolution closeGap(TBPSolution solution, int lowerBound);
+};
+
+/**
+ * Checks that every item is in exactly one bin and that every bin is feasible
+ */
+bool isValidSolution(TemporalBPData & data, const TBPSolution & solution);
+
+/**
+ * Keeps a solution found on the reduced graph when it is valid. Otherwise the first fit replaces it (computed with
+ * the clique bounds of computeBounds if firstFit is empty), and the number of bins of the solution, when proven
+ * optimal on that relaxation, bounds the problem from below. Every solution of a reduced graph goes through it,
+ * so an assignment that is not valid is never reported, let alone as optimal
+ */
+TBPSolution checkRelaxedSolution(TemporalBPData & data, const TBPSolution & solution, const TBPSolution & firstFit);
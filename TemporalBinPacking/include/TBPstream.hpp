@@ -0,0 +1,83 @@
+//
+// Created by lhirwashema on 2022-07-18.
+//
+
+#pragma once
+
+#include "TBPdata.hpp"
+#include <functional>
+#include <istream>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Builds the layered graph while the items arrive, without ever holding the whole instance.
+ *
+ * Items must come by non-decreasing entry date and get chronological IDs in their order of arrival,
+ * items with the same entry date keeping their input order. Maximum cliques are detected with the same
+ * sweep as sweepMaxCliques, and a column is handed to the callback as soon as the next clique is known,
+ * since its arcs only depend on that clique. The callback receives the columns in chronological order
+ * (start, one per clique, sink), their arcs pointing to rows of the column that follows, as for
+ * LayeredGraph::appendColumn.
+ *
+ * Memory is bounded by a window of cliques: the combinations of the pending clique, the raw clique
+ * waiting for its successor in reduced mode, and the items that are still ongoing or belong to those cliques.
+ */
+class StreamingGraphBuilder {
+public:
+    typedef function<void(const GraphColumn &)> ColumnCallback;
+
+    StreamingGraphBuilder(int capacity, bool reduced, const ColumnCallback & onColumn);
+
+    /**
+     * Adds the next item and returns its ID.
+     * Returns -1, leaving the builder unchanged, if it enters before the previous item
+     */
+    int addItem(int size, int entry, int exit);
+
+    /**
+     * Closes the last clique and emits the remaining columns, the sink included
+     */
+    void finish();
+
+    int getNbItems() const { return _nbItems; }
+    int getNbColumns() const { return _nbColumns; }
+    int getMaxNbCombosClique() const { return _maxNbCombosClique; }
+    int getNbLiveItems() const { return _live.size(); }   ///< items currently held in memory
+
+private:
+    int _capacity;
+    bool _reduced;
+    ColumnCallback _onColumn;
+    int _nbItems;
+    int _lastEntry;
+    int _nbColumns;
+    int _maxNbCombosClique;
+    bool _finished;
+
+    unordered_map<int, Item> _live;     ///< items still needed by the window, by ID
+    vector<int> _ongoing;               ///< ongoing items, by increasing ID
+    ///< exit events of ongoing items, earliest first
+    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> _exits;
+
+    int _nbRawCliques;
+    vector<int> _pendingRaw;            ///< reduced mode: clique waiting for the next one to be reduced
+    vector<int> _previousReduced;       ///< reduced mode: last reduced clique
+
+    bool _hasPending;
+    FeasibleCombos _pending;            ///< combinations of the last clique, not linked yet
+
+    void closeClique();
+    void onRawClique(const vector<int> & clique);
+    void onClique(const vector<int> & clique);
+    void emit(const GraphColumn & column);
+    void collectGarbage();
+};
+
+/**
+ * Reads an instance in the format of TemporalBPData(ifstream &) and streams its items into a builder
+ * created from the header. The items of the file must be sorted by entry date.
+ * Returns false if the file is truncated or not sorted, the columns emitted so far being then incomplete
+ */
+bool streamGraph(istream & in, bool reduced, const StreamingGraphBuilder::ColumnCallback & onColumn);
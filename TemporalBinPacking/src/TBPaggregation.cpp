@@ -0,0 +1,316 @@
+//
+// Created by lhirwashema on 2022-08-03.
+//
+
+#include "../include/TBPaggregation.hpp"
+#include "../include/TBPparallel.hpp"
+#include "../include/TBPprofile.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <tuple>
+
+using namespace std;
+
+ItemTypes groupIdenticalItems(const vector<Item> & items, const CliqueSet & cliques){
+    const int nbItems = items.size();
+    ItemTypes types;
+    vector<int> firstClique(nbItems, -1);
+    vector<int> lastClique(nbItems, -1);
+    for (int c = 0; c < cliques.getNbCliques(); c++) {
+        for (const int * it = cliques.begin(c); it != cliques.end(c); it++) {
+            if (firstClique[*it] == -1) firstClique[*it] = c;
+            lastClique[*it] = c;
+        }
+    }
+
+    ///< the cliques of an item are consecutive, its first and last ones give all of them
+    map<tuple<int, int, int>, int> typeOfKey;
+    types._typeOfItem.resize(nbItems);
+    for (int i = 0; i < nbItems; i++) {
+        const auto key = make_tuple(items[i]._size, firstClique[i], lastClique[i]);
+        auto found = typeOfKey.find(key);
+        if (found == typeOfKey.end()) {
+            found = typeOfKey.insert(make_pair(key, types.getNbTypes())).first;
+            types._sizes.push_back(items[i]._size);
+        }
+        types._typeOfItem[i] = found->second;
+    }
+
+    types._itemOffsets.assign(types.getNbTypes() + 1, 0);
+    for (const auto & type : types._typeOfItem)
+        types._itemOffsets[type + 1]++;
+    for (int t = 0; t < types.getNbTypes(); t++)
+        types._itemOffsets[t + 1] += types._itemOffsets[t];
+    types._items.resize(nbItems);
+    vector<int> fill(types._itemOffsets.begin(), types._itemOffsets.end() - 1);
+    for (int i = 0; i < nbItems; i++)
+        types._items[fill[types._typeOfItem[i]]++] = i;
+
+    vector<int> cliqueTypes;
+    for (int c = 0; c < cliques.getNbCliques(); c++) {
+        cliqueTypes.clear();
+        for (const int * it = cliques.begin(c); it != cliques.end(c); it++)
+            cliqueTypes.push_back(types._typeOfItem[*it]);
+        sort(cliqueTypes.begin(), cliqueTypes.end());
+        cliqueTypes.erase(unique(cliqueTypes.begin(), cliqueTypes.end()), cliqueTypes.end());
+        types._cliques._items.insert(types._cliques._items.end(), cliqueTypes.begin(), cliqueTypes.end());
+        types._cliques.closeClique();
+    }
+    return types;
+}
+
+/**
+ * Takes every possible number of items of the type at position k, as long as they fit, then goes on with the next type
+ */
+static void extendMultiset(const ItemTypes & types, MultisetCombos & combos, int k, long load, int capacity, vector<int> & counts){
+    if (k == combos.getNbTypes()) {
+        combos._counts.insert(combos._counts.end(), counts.begin(), counts.end());
+        return;
+    }
+    const int & type = combos._types[k];
+    for (int n = 0; n <= types.getMultiplicity(type) && load + (long)n * types._sizes[type] <= capacity; n++) {
+        counts[k] = n;
+        extendMultiset(types, combos, k + 1, load + (long)n * types._sizes[type], capacity, counts);
+    }
+    counts[k] = 0;
+}
+
+MultisetCombos enumerateMultisets(const ItemTypes & types, const int * cliqueBegin, const int * cliqueEnd, int capacity){
+    MultisetCombos combos;
+    combos._types.assign(cliqueBegin, cliqueEnd);
+    vector<int> counts(combos.getNbTypes(), 0);
+    extendMultiset(types, combos, 0, 0, capacity, counts);
+    return combos;
+}
+
+/**
+ * Appends the items of a multiset to a list, each type repeated as many times as it is taken
+ */
+static void appendTypes(const MultisetCombos & combos, int c, const vector<int> & positions, ArenaIntVector & items){
+    const int * counts = combos.getCounts(c);
+    for (const auto & k : positions)
+        for (int n = 0; n < counts[k]; n++)
+            items.push_back(combos._types[k]);
+}
+
+/**
+ * Creates the arcs of the multisets of a clique towards those of the next clique (the sink if next is null).
+ * The multisets of the next clique are sorted by their counts of the shared types, so that the successors of
+ * a multiset are found by a binary search on its own counts of these types
+ */
+static void linkMultisets(const MultisetCombos & current, const MultisetCombos * next, GraphColumn & column){
+    if (next == nullptr) {
+        for (int u = 0; u < current.size(); u++) {
+            column.closeArc(0);
+            column._arcOffsets.push_back(column._arcTargets.size());
+        }
+        return;
+    }
+
+    vector<int> sharedCurrent;
+    vector<int> sharedNext;
+    vector<int> newNext;   ///< positions of the types of the next clique that this one does not hold
+    for (int i = 0, j = 0; j < next->getNbTypes(); j++) {
+        while (i < current.getNbTypes() && current._types[i] < next->_types[j])
+            i++;
+        if (i < current.getNbTypes() && current._types[i] == next->_types[j]) {
+            sharedCurrent.push_back(i);
+            sharedNext.push_back(j);
+        } else {
+            newNext.push_back(j);
+        }
+    }
+    const int nbShared = sharedNext.size();
+    vector<int> nextKeys((size_t)next->size() * nbShared);
+    for (int v = 0; v < next->size(); v++)
+        for (int k = 0; k < nbShared; k++)
+            nextKeys[(size_t)v * nbShared + k] = next->getCounts(v)[sharedNext[k]];
+    auto keyLess = [&](const int * a, const int * b){ return lexicographical_compare(a, a + nbShared, b, b + nbShared); };
+
+    vector<int> order(next->size());
+    for (int v = 0; v < next->size(); v++)
+        order[v] = v;
+    sort(order.begin(), order.end(), [&](int v, int w){
+        const int * vKey = nextKeys.data() + (size_t)v * nbShared;
+        const int * wKey = nextKeys.data() + (size_t)w * nbShared;
+        return keyLess(vKey, wKey) || (!keyLess(wKey, vKey) && v < w);
+    });
+
+    vector<int> key(nbShared);
+    for (int u = 0; u < current.size(); u++) {
+        for (int k = 0; k < nbShared; k++)
+            key[k] = current.getCounts(u)[sharedCurrent[k]];
+        auto first = lower_bound(order.begin(), order.end(), key.data(), [&](int v, const int * k){
+            return keyLess(nextKeys.data() + (size_t)v * nbShared, k);
+        });
+        for (auto it = first; it != order.end() && !keyLess(key.data(), nextKeys.data() + (size_t)*it * nbShared); it++) {
+            appendTypes(*next, *it, newNext, column._arcItems);
+            column.closeArc(*it);
+        }
+        column._arcOffsets.push_back(column._arcTargets.size());
+    }
+}
+
+AggregatedGraph buildAggregatedGraph(const TemporalBPData & data){
+    TBP_PROFILE_SCOPE("aggregatedGraph");
+    AggregatedGraph aggregated;
+    aggregated._types = groupIdenticalItems(data._items, data.getMaxCliqueSet());
+    const ItemTypes & types = aggregated._types;
+    const int nbCliques = types._cliques.getNbCliques();
+    const int nbWorkers = data._buildOptions._nbWorkers;
+    vector<MultisetCombos> combos(nbCliques);
+    vector<GraphColumn> columns(nbCliques + 2);   ///< the start, one column per clique and the sink
+
+    parallelFor(nbCliques, nbWorkers, [&](int a){
+        combos[a] = enumerateMultisets(types, types._cliques.begin(a), types._cliques.end(a), data.getCapacity());
+        vector<int> positions(combos[a].getNbTypes());
+        for (int k = 0; k < (int)positions.size(); k++)
+            positions[k] = k;
+        GraphColumn & column = columns[a + 1];
+        for (int c = 0; c < combos[a].size(); c++) {
+            appendTypes(combos[a], c, positions, column._items);
+            column._itemOffsets.push_back(column._items.size());
+        }
+    });
+    parallelFor(nbCliques, nbWorkers, [&](int a){
+        linkMultisets(combos[a], a + 1 < nbCliques ? &combos[a + 1] : nullptr, columns[a + 1]);
+    });
+
+    columns[nbCliques + 1].closeVertex();   ///< the sink
+    GraphColumn & start = columns[0];       ///< the start connects to every multiset of the first clique
+    if (nbCliques > 0) {
+        const GraphColumn & first = columns[1];
+        for (int v = 0; v < first.getNbVertices(); v++) {
+            start._arcItems.insert(start._arcItems.end(),
+                                   first._items.begin() + first._itemOffsets[v],
+                                   first._items.begin() + first._itemOffsets[v + 1]);
+            start.closeArc(v);
+        }
+    }
+    start.closeVertex();
+    aggregated._graph.assemble(columns);
+    TBP_PROFILE_COUNT("aggregatedGraph.types", types.getNbTypes());
+    return aggregated;
+}
+
+TBPSolution solveAggregated(const TemporalBPData & data, const AggregatedGraph & aggregated){
+    TBP_PROFILE_SCOPE("solver.aggregated");
+    const LayeredGraph & graph = aggregated._graph;
+    const ItemTypes & types = aggregated._types;
+    const int nbItems = data.getNbItems();
+    const int nbTypes = types.getNbTypes();
+    const int nbVertices = graph.getNbVertices();
+    const int nbArcs = graph.getNbArcs();
+    TBPSolution solution;
+    solution._binOfItem.assign(nbItems, -1);
+    if (data.getCapacity() > 0) {
+        for (int c = 0; c < types._cliques.getNbCliques(); c++) {
+            long total = 0;
+            for (const int * it = types._cliques.begin(c); it != types._cliques.end(c); it++)
+                total += (long)types._sizes[*it] * types.getMultiplicity(*it);
+            solution._lowerBound = max<long>(solution._lowerBound, (total + data.getCapacity() - 1) / data.getCapacity());
+        }
+    }
+    if (nbItems == 0 || nbVertices < 2) return solution;
+
+    ///< an uncovered item weighs its size first and counts for one as a tie-breaker
+    vector<long> typeWeight(nbTypes);
+    vector<int> remaining(nbTypes);
+    for (int t = 0; t < nbTypes; t++) {
+        typeWeight[t] = (long)types._sizes[t] * (nbItems + 1) + 1;
+        remaining[t] = types.getMultiplicity(t);
+    }
+
+    ///< the items of an arc are runs of one type; each run counts at most the items left of its type
+    auto forEachRun = [&](int a, const function<void(int, int)> & onRun){
+        for (int k = graph._arcItemOffsets[a]; k < graph._arcItemOffsets[a + 1]; ) {
+            const int & type = graph._arcItems[k];
+            int n = 0;
+            for (; k < graph._arcItemOffsets[a + 1] && graph._arcItems[k] == type; k++)
+                n++;
+            onRun(type, n);
+        }
+    };
+    vector<long> arcWeight(nbArcs, 0);
+    vector<int> typeArcOffsets(nbTypes + 1, 0);
+    for (int a = 0; a < nbArcs; a++)
+        forEachRun(a, [&](int type, int /*n*/){ typeArcOffsets[type + 1]++; });
+    for (int t = 0; t < nbTypes; t++)
+        typeArcOffsets[t + 1] += typeArcOffsets[t];
+    vector<int> typeArcs(typeArcOffsets[nbTypes]);
+    vector<int> typeArcCounts(typeArcOffsets[nbTypes]);
+    vector<int> fill(typeArcOffsets.begin(), typeArcOffsets.end() - 1);
+    for (int a = 0; a < nbArcs; a++) {
+        forEachRun(a, [&](int type, int n){
+            arcWeight[a] += typeWeight[type] * n;
+            typeArcs[fill[type]] = a;
+            typeArcCounts[fill[type]++] = n;
+        });
+    }
+
+    vector<long> best(nbVertices);
+    vector<int> predArc(nbVertices);
+    vector<int> predVertex(nbVertices);
+    vector<int> nextItem(types._itemOffsets.begin(), types._itemOffsets.end() - 1);   ///< first item of each type not handed out
+    const int sink = nbVertices - 1;
+    int nbCovered = 0;
+    while (nbCovered < nbItems) {
+        std::fill(best.begin(), best.end(), -1);
+        best[0] = 0;
+        for (int u = 0; u < nbVertices; u++) {
+            if (best[u] < 0) continue;
+            for (int a = graph._arcOffsets[u]; a < graph._arcOffsets[u + 1]; a++) {
+                const int & v = graph._arcSuccessors[a];
+                if (best[u] + arcWeight[a] > best[v]) {
+                    best[v] = best[u] + arcWeight[a];
+                    predArc[v] = a;
+                    predVertex[v] = u;
+                }
+            }
+        }
+        if (best[sink] <= 0) break;     ///< the remaining items are in no path
+
+        const int bin = solution._nbBins++;
+        for (int v = sink; v != 0; v = predVertex[v]) {
+            forEachRun(predArc[v], [&](int type, int n){
+                const int taken = min(n, remaining[type]);
+                if (taken == 0) return;
+                for (int k = 0; k < taken; k++)
+                    solution._binOfItem[types._items[nextItem[type]++]] = bin;
+                nbCovered += taken;
+                const int left = remaining[type] - taken;
+                for (int e = typeArcOffsets[type]; e < typeArcOffsets[type + 1]; e++)
+                    arcWeight[typeArcs[e]] -= typeWeight[type] * (min(typeArcCounts[e], remaining[type]) - min(typeArcCounts[e], left));
+                remaining[type] = left;
+            });
+        }
+    }
+    if (nbCovered == nbItems && solution._nbBins <= solution._lowerBound) {
+        solution._optimal = true;
+        solution._lowerBound = solution._nbBins;
+    }
+    return solution;
+}
+
+AggregationAttempt trySolveAggregated(const TemporalBPData & data, int target){
+    AggregationAttempt attempt;
+    auto start = chrono::steady_clock::now();
+    AggregatedGraph aggregated = buildAggregatedGraph(data);
+    attempt._graphMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    attempt._nbColumns = aggregated._graph.getNbColumns();
+    attempt._nbVertices = aggregated._graph.getNbVertices();
+    attempt._nbArcs = aggregated._graph.getNbArcs();
+    for (int k = 0; k < NB_GRAPH_ARRAYS; k++)
+        attempt._graphBytes += aggregated._graph.getArray(GraphArray(k)).size() * sizeof(int);
+
+    start = chrono::steady_clock::now();
+    TBPSolution solution = solveAggregated(data, aggregated);
+    attempt._solveMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    if (find(solution._binOfItem.begin(), solution._binOfItem.end(), -1) != solution._binOfItem.end())
+        return attempt;
+    attempt._solved = solution._nbBins <= max(target, solution._lowerBound);
+    attempt._solution = solution;
+    return attempt;
+}
@@ -0,0 +1,58 @@
+//
+// Created by lhirwashema on 2022-07-27.
+//
+
+#include "../include/TBParena.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+MonotonicArena::MonotonicArena(size_t chunkSize) :
+    _chunkSize(chunkSize),
+    _current(nullptr),
+    _left(0),
+    _nbAllocations(0),
+    _nbBytes(0),
+    _nbReserved(0){}
+
+MonotonicArena::~MonotonicArena(){
+    release();
+}
+
+void * MonotonicArena::allocate(size_t size, size_t alignment){
+    lock_guard<mutex> lock(_mutex);
+    _nbAllocations++;
+    _nbBytes += size;
+    if (size > _chunkSize / 4) {    ///< a chunk of its own, the free space of the current chunk stays usable
+        char * chunk = static_cast<char *>(malloc(size));
+        if (!chunk) throw bad_alloc();
+        _chunks.push_back(chunk);
+        _nbReserved += size;
+        return chunk;
+    }
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(_current) % alignment) % alignment;
+    if (_current == nullptr || padding + size > _left) {
+        _current = static_cast<char *>(malloc(_chunkSize));
+        if (!_current) throw bad_alloc();
+        _chunks.push_back(_current);
+        _nbReserved += _chunkSize;
+        _left = _chunkSize;
+        padding = 0;    ///< malloc aligns for every fundamental type
+    }
+    void * p = _current + padding;
+    _current += padding + size;
+    _left -= padding + size;
+    return p;
+}
+
+void MonotonicArena::release(){
+    lock_guard<mutex> lock(_mutex);
+    for (auto & chunk : _chunks)
+        free(chunk);
+    _chunks.clear();
+    _current = nullptr;
+    _left = 0;
+    _nbReserved = 0;
+}
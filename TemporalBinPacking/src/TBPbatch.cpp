@@ -0,0 +1,269 @@
+//
+// Created by lhirwashema on 2022-07-28.
+//
+
+#include "../include/TBPbatch.hpp"
+#include "../include/TBPaggregation.hpp"
+#include "../include/TBPbounds.hpp"
+#include "../include/TBPdecomposition.hpp"
+#include "../include/TBPestimate.hpp"
+#include "../include/TBPevents.hpp"
+#include "../include/TBPparallel.hpp"
+#include "../include/TBPparser.hpp"
+#include "../include/TBPsolver.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using namespace std;
+
+static double elapsedMs(chrono::steady_clock::time_point start){
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Bytes of the arrays of a graph
+ */
+static long getGraphBytes(const LayeredGraph & graph){
+    long bytes = 0;
+    for (int k = 0; k < NB_GRAPH_ARRAYS; k++)
+        bytes += graph.getArray(GraphArray(k)).size() * sizeof(int);
+    return bytes;
+}
+
+/**
+ * Quotes a string for CSV or JSON output
+ */
+static string quote(const string & text){
+    string quoted = "\"";
+    for (const auto & c : text) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+string InstanceResult::getCsvHeader(){
+    return "instance,status,items,components,columns,vertices,arcs,bins,lower_bound,optimal,valid,closed_by_bounds,"
+           "parse_ms,bounds_ms,graph_ms,solve_ms,graph,estimated_graph_kb";
+}
+
+string InstanceResult::toCsv() const {
+    ostringstream out;
+    out << quote(_fileName) << "," << (isValid() ? "ok" : quote(_error)) << ","
+        << _nbItems << "," << _nbComponents << "," << _nbColumns << "," << _nbVertices << "," << _nbArcs << ","
+        << _nbBins << "," << _lowerBound << "," << _optimal << "," << _valid << "," << _closedByBounds << ","
+        << _parseMs << "," << _boundsMs << "," << _graphMs << "," << _solveMs << "," << _graph << "," << _estimatedGraphKb;
+    return out.str();
+}
+
+string InstanceResult::toJson() const {
+    ostringstream out;
+    out << "{\"instance\":" << quote(_fileName) << ",\"status\":" << (isValid() ? "\"ok\"" : quote(_error))
+        << ",\"items\":" << _nbItems << ",\"components\":" << _nbComponents << ",\"columns\":" << _nbColumns
+        << ",\"vertices\":" << _nbVertices << ",\"arcs\":" << _nbArcs
+        << ",\"bins\":" << _nbBins << ",\"lower_bound\":" << _lowerBound
+        << ",\"optimal\":" << (_optimal ? "true" : "false") << ",\"valid\":" << (_valid ? "true" : "false")
+        << ",\"closed_by_bounds\":" << (_closedByBounds ? "true" : "false")
+        << ",\"parse_ms\":" << _parseMs << ",\"bounds_ms\":" << _boundsMs << ",\"graph_ms\":" << _graphMs << ",\"solve_ms\":" << _solveMs
+        << ",\"graph\":" << quote(_graph) << ",\"estimated_graph_kb\":" << _estimatedGraphKb << "}";
+    return out.str();
+}
+
+/**
+ * Admission of the instances of a batch under a memory budget.
+ *
+ * Every running instance holds a reservation: an estimate from its number of items until its graph is built,
+ * then the footprint of its graph. Building a graph needs about FOOTPRINT_RATIO times its arrays, the columns
+ * of the build and the assembled arrays being alive together. The estimate per item is the largest footprint
+ * per item of the graphs built so far, so an instance runs alone until a first graph is known
+ */
+class MemoryGate {
+public:
+    static constexpr double FOOTPRINT_RATIO = 2.5;
+
+    MemoryGate(long budgetKb) : _budgetKb(budgetKb), _nbRunning(0), _reservedKb(0), _kbPerItem(0) {}
+
+    /**
+     * Waits until an instance of nbItems items fits in the budget, returns its reservation
+     */
+    long enter(int nbItems){
+        unique_lock<mutex> lock(_mutex);
+        long estimateKb = 0;
+        _released.wait(lock, [&]{
+            estimateKb = (long)(_kbPerItem * nbItems);
+            return _budgetKb <= 0 || _nbRunning == 0 || (_kbPerItem > 0 && _reservedKb + estimateKb <= _budgetKb);
+        });
+        _nbRunning++;
+        _reservedKb += estimateKb;
+        return estimateKb;
+    }
+
+    /**
+     * Replaces the reservation of an instance by the footprint of its graphs once built,
+     * graphBytes being the arrays of the graphs it holds at a time
+     */
+    void onGraphBuilt(long & reservationKb, int nbItems, long graphBytes){
+        const long footprintKb = (long)(FOOTPRINT_RATIO * graphBytes / 1024);
+        {
+            lock_guard<mutex> lock(_mutex);
+            if (nbItems > 0)
+                _kbPerItem = max(_kbPerItem, (double)footprintKb / nbItems);
+            _reservedKb += footprintKb - reservationKb;
+            reservationKb = footprintKb;
+        }
+        _released.notify_all();
+    }
+
+    void leave(long reservationKb){
+        {
+            lock_guard<mutex> lock(_mutex);
+            _nbRunning--;
+            _reservedKb -= reservationKb;
+#ifdef __GLIBC__
+            if (_budgetKb > 0)
+                malloc_trim(0);   ///< gives the freed memory of the instance back to the system
+#endif
+        }
+        _released.notify_all();
+    }
+
+private:
+    long _budgetKb;
+    int _nbRunning;
+    long _reservedKb;
+    double _kbPerItem;
+    mutex _mutex;
+    condition_variable _released;
+};
+
+int runBatch(const vector<string> & fileNames, const BatchOptions & options, const ResultCallback & onResult){
+    MemoryGate gate(options._memoryBudgetKb);
+    mutex outputMutex;
+    int nbFailures = 0;
+    parallelFor(fileNames.size(), options._nbWorkers, [&](int i){
+        InstanceResult result;
+        result._fileName = fileNames[i];
+        auto start = chrono::steady_clock::now();
+        TBPInstance instance = parseInstance(fileNames[i]);
+        result._parseMs = elapsedMs(start);
+        if (!instance.isValid()) {
+            result._error = instance._error;
+            lock_guard<mutex> lock(outputMutex);
+            nbFailures++;
+            onResult(result, nullptr);
+            return;
+        }
+
+        long reservationKb = gate.enter(instance._items.size());
+        {
+            TemporalBPData data(instance._capacity, instance._items);
+            data._buildOptions = options._buildOptions;
+            vector<Item>().swap(instance._items);
+            result._nbItems = data.getNbItems();
+            TBPBounds bounds;
+            if (options._useBounds) {
+                start = chrono::steady_clock::now();
+                bounds = computeBounds(data);
+                result._boundsMs = elapsedMs(start);
+                result._closedByBounds = bounds.isClosed();
+            }
+
+            result._nbComponents = getTimeComponents(data._items).size() - 1;
+            const bool decompose = options._decompose && result._nbComponents > 1 && !result._closedByBounds;
+
+            TBPSolution solution = bounds._firstFit;
+            if (decompose) {
+                DecomposedSolution decomposed = solveByComponents(data, options._reduced, options._buildOptions._nbWorkers,
+                                                                 options._aggregate && !options._reduced, options._events);
+                solution = decomposed._solution;
+                for (const auto & component : decomposed._components) {   ///< times summed over the components
+                    result._nbColumns += component._nbColumns;
+                    result._graphMs += component._graphMs;
+                    result._solveMs += component._solveMs;
+                }
+                result._nbVertices = decomposed.getNbVertices();
+                result._nbArcs = decomposed.getNbArcs();
+                result._graph = "components";
+                if (decomposed.isOverBudget())
+                    result._error = "graph of a component over the budget of " + to_string(options._buildOptions._graphBudgetKb / 1024) + " MB";
+                gate.onGraphBuilt(reservationKb, data.getNbItems(),
+                                  decomposed.getMaxGraphBytes() * min(options._buildOptions._nbWorkers, result._nbComponents));
+            } else if (!result._closedByBounds) {
+                bool reduced = options._reduced && !options._events;
+                GraphChoice choice = options._events ? GRAPH_EVENTS : reduced ? GRAPH_REDUCED : GRAPH_NORMAL;
+                const long graphBudgetKb = options._buildOptions._graphBudgetKb;
+                if (graphBudgetKb > 0 && !options._events) {   ///< no estimate of the event graph
+                    start = chrono::steady_clock::now();
+                    GraphEstimate estimate;
+                    choice = chooseGraph(data, reduced, graphBudgetKb, &estimate);
+                    result._graphMs = elapsedMs(start);
+                    result._estimatedGraphKb = estimate.getFootprintKb();
+                    reduced = choice == GRAPH_REDUCED;
+                    if (choice != GRAPH_NONE)   ///< reserved ahead from the estimate, replaced once the graph is built
+                        gate.onGraphBuilt(reservationKb, data.getNbItems(), (long)estimate.getGraphBytes());
+                    if (choice == GRAPH_NONE)
+                        result._error = "estimated graph of " + to_string(result._estimatedGraphKb / 1024) + " MB over the budget of "
+                                      + to_string(graphBudgetKb / 1024) + " MB";
+                }
+                bool solved = choice == GRAPH_NONE;   ///< refused, the first fit is kept
+                if ((options._aggregate || choice == GRAPH_AGGREGATED) && !reduced && !solved && choice != GRAPH_EVENTS) {
+                    AggregationAttempt attempt = trySolveAggregated(data, bounds._lowerBound);
+                    result._graphMs += attempt._graphMs;
+                    result._solveMs = attempt._solveMs;
+                    const bool better = !attempt._solution._binOfItem.empty()
+                                     && (bounds._firstFit._binOfItem.empty() || attempt._solution._nbBins < bounds.getUpperBound());
+                    if (attempt._solved || choice == GRAPH_AGGREGATED) {   ///< no graph of the items: the better of the greedy and the first fit
+                        solved = true;
+                        choice = GRAPH_AGGREGATED;
+                        if (attempt._solved || better)
+                            solution = attempt._solution;
+                        solution._lowerBound = max(solution._lowerBound, bounds._lowerBound);
+                        solution._optimal = solution._nbBins <= solution._lowerBound;
+                        result._nbColumns = attempt._nbColumns;
+                        result._nbVertices = attempt._nbVertices;
+                        result._nbArcs = attempt._nbArcs;
+                        gate.onGraphBuilt(reservationKb, data.getNbItems(), attempt._graphBytes);
+                    } else if (better) {
+                        bounds._firstFit = attempt._solution;   ///< starting solution of the solver below
+                    }
+                }
+                if (!solved) {   ///< times added to those of the steps above
+                    start = chrono::steady_clock::now();
+                    if (choice == GRAPH_EVENTS)
+                        data._graph = buildEventGraph(data);
+                    else
+                        data.createGraph(reduced);
+                    result._graphMs += elapsedMs(start);
+                    result._nbColumns = data.getNbColumns();
+                    result._nbVertices = data._graph.getNbVertices();
+                    result._nbArcs = data._graph.getNbArcs();
+                    gate.onGraphBuilt(reservationKb, data.getNbItems(), getGraphBytes(data._graph));
+
+                    start = chrono::steady_clock::now();
+                    TBPSolver solver(data);
+                    solution = options._useBounds || options._aggregate ? solver.solve(bounds) : solver.solve();
+                    if (reduced)   ///< a relaxation, only its bound is kept if it is not valid
+                        solution = checkRelaxedSolution(data, solution, bounds._firstFit);
+                    result._solveMs += elapsedMs(start);
+                }
+                result._graph = getGraphChoiceName(choice);
+            }
+            result._nbBins = solution._nbBins;
+            result._lowerBound = solution._lowerBound;
+            result._optimal = solution._optimal;
+            result._valid = isValidSolution(data, solution);
+
+            lock_guard<mutex> lock(outputMutex);
+            if (!result.isValid())
+                nbFailures++;
+            onResult(result, &data);
+        }   ///< the instance is freed before its reservation is given back
+        gate.leave(reservationKb);
+    });
+    return nbFailures;
+}
@@ -0,0 +1,102 @@
+//
+// Created by lhirwashema on 2022-07-29.
+//
+
+#include "../include/TBPbounds.hpp"
+#include "../include/TBPprofile.hpp"
+#include <queue>
+#include <utility>
+
+using namespace std;
+
+int computeSizeBound(const vector<int> & sizes, int capacity){
+    if (capacity <= 0) return 0;
+    long total = 0;
+    for (const auto & size : sizes)
+        total += size;
+    return (total + capacity - 1) / capacity;
+}
+
+int computeL2Bound(vector<int> sizes, int capacity){
+    if (capacity <= 0 || sizes.empty()) return 0;
+    sort(sizes.begin(), sizes.end());
+    const int n = sizes.size();
+    vector<long> prefix(n + 1, 0);
+    for (int i = 0; i < n; i++)
+        prefix[i + 1] = prefix[i] + sizes[i];
+
+    ///< items larger than capacity/2 never share a bin, they start at halfIndex
+    const int halfIndex = upper_bound(sizes.begin(), sizes.end(), capacity / 2) - sizes.begin();
+    auto evaluate = [&](int threshold){
+        const int bigIndex = upper_bound(sizes.begin() + halfIndex, sizes.end(), capacity - threshold) - sizes.begin();
+        const int thresholdIndex = lower_bound(sizes.begin(), sizes.begin() + halfIndex, threshold) - sizes.begin();
+        const long nbAlone = n - bigIndex;    ///< no item of size at least threshold fits with them
+        const long nbLarge = bigIndex - halfIndex;
+        const long roomLeft = nbLarge * capacity - (prefix[bigIndex] - prefix[halfIndex]);
+        const long smallTotal = prefix[halfIndex] - prefix[thresholdIndex];
+        return nbAlone + nbLarge + max(0L, (smallTotal - roomLeft + capacity - 1) / capacity);
+    };
+    long bound = evaluate(0);
+    for (int k = 0; k < halfIndex; k++)
+        if (k == 0 || sizes[k] != sizes[k - 1])    ///< one threshold per distinct size
+            bound = max(bound, evaluate(sizes[k]));
+    return bound;
+}
+
+TBPSolution solveFirstFit(const TemporalBPData & data){
+    TBP_PROFILE_SCOPE("bounds.firstFit");
+    const int nbItems = data.getNbItems();
+    TBPSolution solution;
+    solution._binOfItem.assign(nbItems, -1);
+
+    vector<long> load;
+    ///< exits of the packed items, earliest first; those of a date are only pushed once its items are packed
+    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> exits;
+    vector<int> group;
+    for (int first = 0; first < nbItems; first += group.size()) {
+        const int entry = data._items[first]._entry;
+        group.clear();
+        for (int i = first; i < nbItems && data._items[i]._entry == entry; i++)
+            group.push_back(i);
+        stable_sort(group.begin(), group.end(), [&](int i, int j){ return data._items[i]._size > data._items[j]._size; });
+
+        while (!exits.empty() && exits.top().first <= entry) {
+            const int item = exits.top().second;
+            load[solution._binOfItem[item]] -= data._items[item]._size;
+            exits.pop();
+        }
+        for (const auto & item : group) {
+            const int size = data._items[item]._size;
+            int bin = 0;
+            while (bin < (int)load.size() && load[bin] + size > data.getCapacity())
+                bin++;
+            if (bin == (int)load.size())
+                load.push_back(0);
+            load[bin] += size;
+            solution._binOfItem[item] = bin;
+        }
+        for (const auto & item : group)
+            exits.push(make_pair(data._items[item]._exit, item));
+    }
+    solution._nbBins = load.size();
+    return solution;
+}
+
+TBPBounds computeBounds(const TemporalBPData & data){
+    TBP_PROFILE_SCOPE("bounds");
+    TBPBounds bounds;
+    const CliqueSet cliques = data.getMaxCliqueSet();
+    vector<int> sizes;
+    for (int c = 0; c < cliques.getNbCliques(); c++) {
+        sizes.clear();
+        for (const int * it = cliques.begin(c); it != cliques.end(c); it++)
+            sizes.push_back(data._items[*it]._size);
+        bounds._sizeBound = max(bounds._sizeBound, computeSizeBound(sizes, data.getCapacity()));
+        bounds._l2Bound = max(bounds._l2Bound, computeL2Bound(sizes, data.getCapacity()));
+    }
+    bounds._lowerBound = max(bounds._sizeBound, bounds._l2Bound);
+    bounds._firstFit = solveFirstFit(data);
+    bounds._firstFit._lowerBound = bounds._lowerBound;
+    bounds._firstFit._optimal = bounds.isClosed();
+    return bounds;
+}
@@ -0,0 +1,186 @@
+//
+// Created by lhirwashema on 2022-07-20.
+//
+
+#include "../include/TBPcache.hpp"
+#include "../include/TBPprofile.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+static const uint32_t GRAPH_FILE_VERSION = 2;
+
+/**
+ * FNV-1a hash, fed one integer at a time
+ */
+static void hashInt(uint64_t & hash, int64_t value){
+    for (int b = 0; b < 8; b++) {
+        hash ^= (value >> (8 * b)) & 0xff;
+        hash *= 1099511628211ULL;
+    }
+}
+
+uint64_t hashGraphKey(int capacity, const vector<Item> & items, bool reduced, bool dominancePruning){
+    uint64_t hash = 14695981039346656037ULL;
+    hashInt(hash, GRAPH_FILE_VERSION);
+    hashInt(hash, capacity);
+    hashInt(hash, reduced);
+    hashInt(hash, dominancePruning);
+    hashInt(hash, items.size());
+    for (const auto & item : items) {   ///< IDs are the chronological ranks, only the dates and sizes matter
+        hashInt(hash, item._entry);
+        hashInt(hash, item._exit);
+        hashInt(hash, item._size);
+    }
+    return hash;
+}
+
+static bool writeAll(int fd, const void * data, size_t length){
+    const char * p = static_cast<const char *>(data);
+    while (length > 0) {
+        ssize_t written = write(fd, p, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += written;
+        length -= written;
+    }
+    return true;
+}
+
+bool writeGraphFile(const string & fileName, uint64_t key, const LayeredGraph & graph, int maxNbCombosClique,
+                    long nbDominatedVertices, long nbDominatedArcs, string & error){
+    GraphFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header._magic, "TBPG", 4);
+    header._version = GRAPH_FILE_VERSION;
+    header._key = key;
+    header._maxNbCombosClique = maxNbCombosClique;
+    header._nbDominatedVertices = nbDominatedVertices;
+    header._nbDominatedArcs = nbDominatedArcs;
+    for (int k = 0; k < NB_GRAPH_ARRAYS; k++)
+        header._sizes[k] = graph.getArray(GraphArray(k)).size();
+
+    const size_t slash = fileName.find_last_of('/');
+    string tmpName = (slash == string::npos ? "" : fileName.substr(0, slash + 1)) + ".graph-XXXXXX";
+    vector<char> tmpPath(tmpName.begin(), tmpName.end());
+    tmpPath.push_back('\0');
+    int fd = mkstemp(tmpPath.data());
+    if (fd < 0) {
+        error = "cannot create a file next to " + fileName + ": " + strerror(errno);
+        return false;
+    }
+
+    bool ok = fchmod(fd, 0644) == 0 && writeAll(fd, &header, sizeof(header));
+    for (int k = 0; ok && k < NB_GRAPH_ARRAYS; k++) {
+        const IntSpan & array = graph.getArray(GraphArray(k));
+        ok = writeAll(fd, array.data(), array.size() * sizeof(int));
+    }
+    ok = ok && fsync(fd) == 0;
+    ok = (close(fd) == 0) && ok;
+    ok = ok && rename(tmpPath.data(), fileName.c_str()) == 0;
+    if (!ok) {
+        error = "cannot write " + fileName + ": " + strerror(errno);
+        unlink(tmpPath.data());
+    }
+    return ok;
+}
+
+bool mapGraphFile(const string & fileName, uint64_t key, LayeredGraph & graph, int & maxNbCombosClique,
+                  long & nbDominatedVertices, long & nbDominatedArcs, string & error){
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "no graph file";
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size < (off_t)sizeof(GraphFileHeader)) {
+        error = "truncated graph file";
+        close(fd);
+        return false;
+    }
+    const size_t length = status.st_size;
+    void * data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        error = "cannot map the graph file: " + string(strerror(errno));
+        return false;
+    }
+    shared_ptr<const void> mapping(data, [length](const void * p){ munmap(const_cast<void *>(p), length); });
+
+    const GraphFileHeader & header = *static_cast<const GraphFileHeader *>(data);
+    if (memcmp(header._magic, "TBPG", 4) != 0 || header._version != GRAPH_FILE_VERSION || header._key != key) {
+        error = "graph file of another instance or version";
+        return false;
+    }
+    uint64_t total = 0;
+    for (int k = 0; k < NB_GRAPH_ARRAYS; k++)
+        total += header._sizes[k];
+    if (total > (length - sizeof(header)) / sizeof(int) || sizeof(header) + total * sizeof(int) != length) {
+        error = "truncated graph file";
+        return false;
+    }
+
+    vector<IntSpan> arrays;
+    const int * p = reinterpret_cast<const int *>(static_cast<const char *>(data) + sizeof(header));
+    for (int k = 0; k < NB_GRAPH_ARRAYS; k++) {
+        arrays.push_back(IntSpan(p, header._sizes[k]));
+        p += header._sizes[k];
+    }
+
+    ///< the offsets have to match the sizes of the arrays they index
+    const IntSpan & columnOffsets = arrays[COLUMN_OFFSETS];
+    const IntSpan & vertexItemOffsets = arrays[VERTEX_ITEM_OFFSETS];
+    const IntSpan & arcOffsets = arrays[ARC_OFFSETS];
+    const IntSpan & arcItemOffsets = arrays[ARC_ITEM_OFFSETS];
+    if (columnOffsets.empty() || vertexItemOffsets.empty() || arcOffsets.empty() || arcItemOffsets.empty()
+     || vertexItemOffsets.size() != arcOffsets.size()
+     || (size_t)columnOffsets.back() + 1 != vertexItemOffsets.size()
+     || (size_t)vertexItemOffsets.back() != arrays[VERTEX_ITEMS].size()
+     || (size_t)arcOffsets.back() != arrays[ARC_SUCCESSORS].size()
+     || arcItemOffsets.size() != arrays[ARC_SUCCESSORS].size() + 1
+     || (size_t)arcItemOffsets.back() != arrays[ARC_ITEMS].size()) {
+        error = "inconsistent graph file";
+        return false;
+    }
+
+    graph.mapArrays(mapping, arrays);
+    maxNbCombosClique = header._maxNbCombosClique;
+    nbDominatedVertices = header._nbDominatedVertices;
+    nbDominatedArcs = header._nbDominatedArcs;
+    return true;
+}
+
+string GraphCache::getFileName(uint64_t key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.graph", (unsigned long long)key);
+    return _folder + "/" + name;
+}
+
+bool GraphCache::loadOrBuild(TemporalBPData & data, bool reduced) const {
+    const uint64_t key = hashGraphKey(data._capacity, data._items, reduced, data._buildOptions._dominancePruning);
+    const string fileName = getFileName(key);
+    string error;
+    if (mapGraphFile(fileName, key, data._graph, data._maxNbCombosClique, data._nbDominatedVertices, data._nbDominatedArcs, error)) {
+        TBP_PROFILE_COUNT("graphCache.hit", 1);
+        return true;
+    }
+    TBP_PROFILE_COUNT("graphCache.miss", 1);
+
+    if (reduced)
+        data._graph = data.buildReducedGraph();
+    else
+        data._graph = data.buildGraph();
+
+    mkdir(_folder.c_str(), 0755);   ///< may already exist
+    if (!writeGraphFile(fileName, key, data._graph, data._maxNbCombosClique, data._nbDominatedVertices, data._nbDominatedArcs, error))
+        cerr << "<GraphCache> " << error << endl;
+    return false;
+}
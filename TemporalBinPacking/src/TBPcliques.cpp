@@ -0,0 +1,87 @@
+//
+// Created by lhirwashema on 2022-07-06.
+//
+
+#include "../include/TBPcliques.hpp"
+#include "../include/TBPdata.hpp"
+#include <functional>
+#include <queue>
+#include <utility>
+
+using namespace std;
+
+CliqueSet::CliqueSet(const vector<vector<int>> & cliques) : _offsets(1, 0) {
+    for (const auto & clique : cliques) {
+        _items.insert(_items.end(), clique.begin(), clique.end());
+        closeClique();
+    }
+}
+
+vector<vector<int>> CliqueSet::toVectors() const {
+    vector<vector<int>> cliques(getNbCliques());
+    for (int c = 0; c < getNbCliques(); c++) {
+        cliques[c].assign(begin(c), end(c));
+    }
+    return cliques;
+}
+
+/**
+ * Same sweep as sweepMaxCliques, counting the ongoing items instead of listing them,
+ * so that the output buffer is allocated once
+ */
+static long countMaxCliqueItems(const vector<Item> & items){
+    long total = 0;
+    int nbOngoing = 0;
+    priority_queue<int, vector<int>, greater<int>> exits;
+    for (const auto & curItem : items) {
+        if (!exits.empty() && exits.top() <= curItem._entry) {
+            total += nbOngoing;
+            while (!exits.empty() && exits.top() <= curItem._entry) {
+                exits.pop();
+                nbOngoing--;
+            }
+        }
+        nbOngoing++;
+        exits.push(curItem._exit);
+    }
+    return total + nbOngoing;
+}
+
+CliqueSet sweepMaxCliques(const vector<Item> & items){
+    const int nbItems = items.size();
+    CliqueSet cliques;
+    cliques._offsets.reserve(nbItems + 1);
+    cliques._items.reserve(countMaxCliqueItems(items));
+
+    vector<int> ongoing;                   ///< ongoing items, by increasing ID
+    vector<char> left(nbItems, 0);         ///< left[j] is set once item j has exited
+    ///< exit events of ongoing items, earliest first
+    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> exits;
+
+    for (int i = 0; i < nbItems; i++) {
+        const Item & curItem = items[i];
+        if (!exits.empty() && exits.top().first <= curItem._entry) {
+            ///< an ongoing item leaves before the current one enters: the ongoing items form a clique
+            cliques._items.insert(cliques._items.end(), ongoing.begin(), ongoing.end());
+            cliques.closeClique();
+
+            while (!exits.empty() && exits.top().first <= curItem._entry) {
+                left[exits.top().second] = 1;
+                exits.pop();
+            }
+            ///< all exits of this step are removed in a single pass
+            int kept = 0;
+            for (const auto & j : ongoing)
+                if (!left[j]) ongoing[kept++] = j;
+            ongoing.resize(kept);
+        }
+
+        ongoing.push_back(i);
+        exits.push(make_pair(curItem._exit, i));
+    }
+
+    ///< the final items present since the last entry also form a clique
+    cliques._items.insert(cliques._items.end(), ongoing.begin(), ongoing.end());
+    cliques.closeClique();
+    return cliques;
+}
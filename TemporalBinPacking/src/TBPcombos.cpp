@@ -0,0 +1,154 @@
+//
+// Created by lhirwashema on 2022-07-04.
+//
+
+#include "../include/TBPcombos.hpp"
+#include "../include/TBPdata.hpp"
+#include "../include/TBPprofile.hpp"
+
+using namespace std;
+
+vector<int> FeasibleCombos::getItems(int c) const {
+    vector<int> items;
+    appendItems(c, items);
+    return items;
+}
+
+int FeasibleCombos::removeDominated(const vector<char> & isLocal){
+    const int nbCombos = size();
+    auto lessMask = [&](const uint64_t * a, const uint64_t * b){
+        return lexicographical_compare(a, a + _nbWords, b, b + _nbWords);
+    };
+    vector<int> order(nbCombos);
+    for (int c = 0; c < nbCombos; c++)
+        order[c] = c;
+    sort(order.begin(), order.end(), [&](int c, int d){ return lessMask(getMask(c), getMask(d)); });
+
+    ///< feasibility being hereditary, a combination is dominated as soon as one more local item fits
+    vector<uint64_t> extended(_nbWords);
+    vector<char> keep(nbCombos, 1);
+    for (int c = 0; c < nbCombos; c++) {
+        for (int k = 0; k < getNbItems() && keep[c]; k++) {
+            if (!isLocal[k] || contains(c, k)) continue;
+            extended.assign(getMask(c), getMask(c) + _nbWords);
+            extended[k >> 6] |= uint64_t(1) << (k & 63);
+            keep[c] = !binary_search(order.begin(), order.end(), -1, [&](int d, int e){
+                return lessMask(d < 0 ? extended.data() : getMask(d), e < 0 ? extended.data() : getMask(e));
+            });
+        }
+    }
+
+    int kept = 0;
+    for (int c = 0; c < nbCombos; c++) {
+        if (!keep[c]) continue;
+        copy(getMask(c), getMask(c) + _nbWords, _masks.begin() + kept * _nbWords);
+        kept++;
+    }
+    _masks.resize(kept * _nbWords);
+    return nbCombos - kept;
+}
+
+static bool smallerId(const Item * i, const Item * j) {
+    return i->_id < j->_id;
+}
+
+ComboEnumerator::ComboEnumerator(const vector<Item> & items, int capacity, const vector<int> & clique) :
+    _capacity(capacity),
+    _nbItems(clique.size()),
+    _nbChecks(0)
+{
+    vector<const Item *> cliqueItems;
+    cliqueItems.reserve(clique.size());
+    for (const auto & itemId : clique)
+        cliqueItems.push_back(&items[itemId]);
+    init(cliqueItems);
+}
+
+ComboEnumerator::ComboEnumerator(const vector<const Item *> & cliqueItems, int capacity) :
+    _capacity(capacity),
+    _nbItems(cliqueItems.size()),
+    _nbChecks(0)
+{
+    init(cliqueItems);
+}
+
+void ComboEnumerator::init(vector<const Item *> sorted){
+    if (!is_sorted(sorted.begin(), sorted.end(), smallerId))     ///< IDs were assigned by increasing entry date
+        sort(sorted.begin(), sorted.end(), smallerId);
+
+    _combos._nbWords = (_nbItems + 63) / 64;
+    if (_combos._nbWords == 0)
+        _combos._nbWords = 1;
+    _current.assign(_combos._nbWords, 0);
+
+    vector<int> entries(_nbItems);
+    _combos._items.reserve(_nbItems);
+    _sizes.reserve(_nbItems);
+    for (int k = 0; k < _nbItems; k++) {
+        _combos._items.push_back(sorted[k]->_id);
+        _sizes.push_back(sorted[k]->_size);
+        entries[k] = sorted[k]->_entry;
+    }
+
+    ///< an item leaves the bin right before the first entry that is not earlier than its exit
+    vector<int> expireAt(_nbItems, _nbItems);
+    vector<int> counts(_nbItems + 1, 0);
+    for (int j = 0; j < _nbItems; j++) {
+        expireAt[j] = lower_bound(entries.begin() + j + 1, entries.end(), sorted[j]->_exit) - entries.begin();
+        counts[expireAt[j]]++;
+    }
+    _expireOffsets.assign(_nbItems + 2, 0);
+    for (int k = 0; k <= _nbItems; k++)
+        _expireOffsets[k + 1] = _expireOffsets[k] + counts[k];
+    _expire.resize(_expireOffsets[_nbItems + 1]);
+    vector<int> fill(_expireOffsets.begin(), _expireOffsets.end() - 1);
+    for (int j = 0; j < _nbItems; j++)
+        _expire[fill[expireAt[j]]++] = j;
+
+    _persistent.resize(_nbItems);
+    for (int j = 0; j < _nbItems; j++)
+        _persistent[j] = (expireAt[j] == _nbItems);
+
+    _minSizeFrom.assign(_nbItems + 1, _capacity + 1);
+    for (int k = _nbItems - 1; k >= 0; k--)
+        _minSizeFrom[k] = min(_sizes[k], _minSizeFrom[k + 1]);
+}
+
+/**
+ * Enumerates all feasible combinations, in the order of the former recursive enumeration:
+ * the first item of the clique is the most significant bit and combinations come by increasing mask.
+ */
+FeasibleCombos ComboEnumerator::enumerate(){
+    _combos._masks.clear();
+    _nbChecks = 0;
+    explore(0, 0, 0);
+    FeasibleCombos combos;      ///< the masks are handed over, only the items are copied for a next call
+    combos._items = _combos._items;
+    combos._nbWords = _combos._nbWords;
+    combos._masks.swap(_combos._masks);
+    return combos;
+}
+
+void ComboEnumerator::emit(){
+    _combos._masks.insert(_combos._masks.end(), _current.begin(), _current.end());
+}
+
+void ComboEnumerator::explore(int k, int load, int persistentLoad){
+    for (int e = _expireOffsets[k]; e < _expireOffsets[k + 1]; e++) {   ///< items leaving before the entry of item k
+        const int & j = _expire[e];
+        if ((_current[j >> 6] >> (j & 63)) & 1)
+            load -= _sizes[j];
+    }
+    if (k == _nbItems || persistentLoad + _minSizeFrom[k] > _capacity) {
+        ///< no remaining item can join the combination
+        emit();
+        return;
+    }
+    explore(k + 1, load, persistentLoad);     ///< without item k
+    TBP_PROFILE_ONLY(_nbChecks++);
+    if (load + _sizes[k] <= _capacity) {      ///< with item k
+        _current[k >> 6] |= uint64_t(1) << (k & 63);
+        explore(k + 1, load + _sizes[k], persistentLoad + (_persistent[k] ? _sizes[k] : 0));
+        _current[k >> 6] &= ~(uint64_t(1) << (k & 63));
+    }
+}
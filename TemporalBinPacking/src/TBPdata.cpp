@@ -3,6 +3,11 @@
 //
 
 #include "../include/TBPdata.hpp"
+#include "../include/TBPbounds.hpp"
+#include "../include/TBPcache.hpp"
+#include "../include/TBPlinker.hpp"
+#include "../include/TBPparallel.hpp"
+#include "../include/TBPprofile.hpp"
 
 using namespace std;
 
@@ -20,7 +25,11 @@ static bool smallerEntry(const Item & i, const Item & j) {    ///< item entry da
 
 
 
-TemporalBPData::TemporalBPData(bool reduced){       ///< parser not implemented yet
+TemporalBPData::TemporalBPData(bool reduced) :       ///< parser not implemented yet
+    _maxNbCombosClique(0),
+    _nbDominatedVertices(0),
+    _nbDominatedArcs(0)
+{
 /*    _capacity = 15;
     _items = {{0,6,6,20},
                 {1,4,10,26},
@@ -44,22 +53,35 @@ TemporalBPData::TemporalBPData(bool reduced){       ///< parser not implemented
         _graph = buildGraph();   
 }
 
-TemporalBPData::TemporalBPData(){       ///< parser not implemented yet
+TemporalBPData::TemporalBPData() :       ///< parser not implemented yet
+    _maxNbCombosClique(0),
+    _nbDominatedVertices(0),
+    _nbDominatedArcs(0)
+{
     TemporalBPData(false);
 }
 
-TemporalBPData::TemporalBPData(std::ifstream &in, bool reduced){
+TemporalBPData::TemporalBPData(std::ifstream &in, bool reduced) :
+    TemporalBPData(in, reduced, GraphBuildOptions()){}
+
+TemporalBPData::TemporalBPData(std::ifstream &in, bool reduced, const GraphBuildOptions & options) :
+    _maxNbCombosClique(0),
+    _buildOptions(options),
+    _nbDominatedVertices(0),
+    _nbDominatedArcs(0)
+{
     int nbItems;
+    int unused;    ///< the last two fields of the header are not used
     in >> nbItems;
     in >> _capacity;
+    in >> unused;
+    in >> unused;
+
     int id;
     int entry;
     int exit;
     int size;
 
-    in >> entry;
-    in >> exit;
-
     for (unsigned int i = 0; i < nbItems; ++i) {
         in >> id;
         in >> entry;
@@ -74,14 +96,51 @@ TemporalBPData::TemporalBPData(std::ifstream &in, bool reduced){
         _items[i]._id = i;
     }
 
-    if (reduced)
+    createGraph(reduced);
+}
+
+
+TemporalBPData::TemporalBPData(int capacity, const vector<Item> & items) :
+    _capacity(capacity),
+    _items(items),
+    _maxNbCombosClique(0),
+    _nbDominatedVertices(0),
+    _nbDominatedArcs(0)
+{
+    sort(_items.begin(), _items.end(), smallerEntry);
+
+    for (unsigned int i = 0; i < _items.size(); ++i) { // changing IDs to chronological entry order
+        _items[i]._id = i;
+    }
+}
+
+
+TemporalBPData::TemporalBPData(int capacity, const vector<Item> & items, bool reduced, const GraphBuildOptions & options) :
+    TemporalBPData(capacity, items)
+{
+    _buildOptions = options;
+    createGraph(reduced);
+}
+
+void TemporalBPData::createGraph(bool reduced){
+    _cliqueCombos = CliqueCombos();
+    _nbDominatedVertices = 0;   ///< counted by the build, or read from the cache
+    _nbDominatedArcs = 0;
+    if (!_buildOptions._cacheFolder.empty())
+        GraphCache(_buildOptions._cacheFolder).loadOrBuild(*this, reduced);
+    else if (reduced)
         _graph = buildReducedGraph();
     else
-        _graph = buildGraph();    
+        _graph = buildGraph();
+    _cliqueCombos._reduced = reduced;   ///< a graph from the cache has no combinations, an update builds it again
 }
 
 
-TemporalBPData::TemporalBPData(std::ifstream &in){
+TemporalBPData::TemporalBPData(std::ifstream &in) :
+    _maxNbCombosClique(0),
+    _nbDominatedVertices(0),
+    _nbDominatedArcs(0)
+{
     TemporalBPData(in, false);
 }
 
@@ -98,25 +157,15 @@ bool isItemIn(const int & id, const vector<int> & ids){
  * Computes the maximum cliques within our list of items
  */
 vector<vector<int>> TemporalBPData::getMaxCliques(){
-    vector<vector<int>> cliques;   ///< list of maximum cliques
-    vector<int> ongoing;           ///< list of items who have yet to exit
-    for (const auto & curItem : _items) {   ///< we iterate over items sorted by increasing entry date
-        for (int j=ongoing.size()-1; j>=0; j--) {   ///<we iterate over ongoing items
-            Item & pastItem = _items[ongoing[j]];
-            if (pastItem._exit <= curItem._entry) {   ///< if it is time for an ongoing item to leave
-                if ( cliques.size()==0 || !isItemIn(ongoing[ongoing.size()-1], cliques[cliques.size()-1])){
-                    ///< if the last item added in the ongoing list does not belong in our latest clique
-                    vector<int> clique = ongoing;      ///< then we have a new clique with at least the last item of ongoing
-                    cliques.push_back(clique);         //< as a new item in a clique.   
-                }
-                ongoing.erase(ongoing.begin()+j);
-            }
-        }
-        ongoing.push_back(curItem._id);
-    }
+    return getMaxCliqueSet().toVectors();
+}
 
-    cliques.push_back(ongoing);     ///< the final items present since the last entry also form a clique
-    return cliques;
+/**
+ * Computes the maximum cliques with a sweep line over entry and exit dates, in CSR layout
+ */
+CliqueSet TemporalBPData::getMaxCliqueSet() const {
+    TBP_PROFILE_SCOPE("getMaxCliques");
+    return sweepMaxCliques(_items);
 }
 
 
@@ -126,6 +175,7 @@ vector<vector<int>> TemporalBPData::getMaxCliques(){
  * without violating the capacity constraint
  */
 bool TemporalBPData::isFeasible(vector<int> & selection){
+    TBP_PROFILE_COUNT("isFeasible", 1);
     sort(selection.begin(), selection.end());    ///< Sorting items by entry date from IDs since these were assigned by increasing entry date
     int weight = 0;
     vector<int> ongoing;
@@ -153,6 +203,27 @@ bool TemporalBPData::isFeasible(vector<int> & selection){
  * Each combination must respect the capacity constraint
  */
 vector<vector<int>> TemporalBPData::getFeasibleCombinations(vector<int> clique){
+    FeasibleCombos combos = getFeasibleCombos(clique);
+    vector<vector<int>> group(combos.size());
+    for (int c = 0; c < combos.size(); c++) {
+        combos.appendItems(c, group[c]);
+    }
+    return group;
+}
+
+/**
+ * Computes the feasible combinations of a clique as bitmasks stored in one flat buffer.
+ * The clique is expected in entry order, as returned by getMaxCliques
+ */
+FeasibleCombos TemporalBPData::getFeasibleCombos(const vector<int> & clique) const {
+    ComboEnumerator enumerator(_items, _capacity, clique);
+    return enumerator.enumerate();
+}
+
+/**
+ * Former recursive enumeration, kept as a reference for the benchmarks
+ */
+vector<vector<int>> TemporalBPData::getFeasibleCombinationsRecursive(vector<int> clique){
     vector<vector<int>> group;
     if (clique.empty()) {
         vector<int> empty;
@@ -161,7 +232,7 @@ vector<vector<int>> TemporalBPData::getFeasibleCombinations(vector<int> clique){
         int itemId = clique[clique.size()-1];
         clique.pop_back();
 
-        for (vector<int> combo : getFeasibleCombinations(clique)) {
+        for (vector<int> combo : getFeasibleCombinationsRecursive(clique)) {
             group.push_back(combo);
             combo.push_back(itemId);
             if (isFeasible(combo)) {
@@ -173,14 +244,23 @@ vector<vector<int>> TemporalBPData::getFeasibleCombinations(vector<int> clique){
     return group;
 }
 
-bool isSuccessor(const Vertex & v, const vector<int> & include, const vector<int> & exclude){
+/**
+ * Determines whether an item's id is present in a range of ids
+ */
+static bool isItemIn(const int & id, const int * begin, const int * end){
+    for (const int * i = begin; i != end; i++)
+        if (*i == id) return true;
+    return false;
+}
+
+static bool isSuccessor(const int * itemsBegin, const int * itemsEnd, const vector<int> & include, const vector<int> & exclude){
     for (const int & it : include) {
-        if (!isItemIn(it, v._items)) {
+        if (!isItemIn(it, itemsBegin, itemsEnd)) {
             return false;
         }
     }
     for (const int & it : exclude) {
-        if (isItemIn(it, v._items)) {
+        if (isItemIn(it, itemsBegin, itemsEnd)) {
             return false;
         }
     }
@@ -189,113 +269,255 @@ bool isSuccessor(const Vertex & v, const vector<int> & include, const vector<int
 
 /**
  * Computes a graph to modelize the TBP problem as a minimum cost flow problem.
- * The graph is constructed from sink to start, linking each created vertex to its predecessor in the next step
+ * Each vertex of a clique is linked to its successors in the next clique, the columns being in chronological order
  */
-vector<vector<Vertex>> TemporalBPData::buildGraph(){
-    vector<vector<int>> cliques = getMaxCliques();
-    int maxNbCombosClique = 0;
-    vector<vector<Vertex>> graph;
-    Vertex start;
-    int nbVertices = 0;
-    Vertex sink;
-    sink._id = nbVertices;
-    vector<Vertex> sinkColumn;  ///< First we create the sink vertex and put it in the final column of our graph
-    sinkColumn.push_back(sink);
-    graph.push_back(sinkColumn);
-
-    nbVertices++;
-    ///< We iterate over all maximum cliques from last to first, each clique corresponding to a column in our graph
-    for (int a=cliques.size()-1; a>=0; a--) {
-        vector<vector<int>> combos = getFeasibleCombinations(cliques[a]);
-        if (combos.size() > maxNbCombosClique)
-        {
-            maxNbCombosClique = combos.size();
-        }
-        
-        vector<Vertex> column;
-        for (int c=combos.size()-1; c>=0; c--) {
-            vector<int> selection = combos[c];
-            Vertex u;   ///< for each feasible combination of items in a clique, we create a vertex
-            u._items = selection;
-            u._id = nbVertices;
-            if (a==cliques.size()-1) {  ///< any vertex constructed in the last clique connects to the sink
-                Arc toSink = {sink._id};
-                u._arcs.push_back(toSink);
-            }else{  ///< otherwise that vertex must connect to a vertex in the next clique (previous clique in our exploration order)
-                vector<int> exclude;   ///< vertices containing these items should be excuded
-                vector<int> include;   ///< vertices containing these items should be incuded
-                for (const auto & it : selection) {
-                    if (isItemIn(it, cliques[a+1])) {
-                        ///< if an item in our vertex exist in the next clique
-                        include.push_back(it);  ///< then we can only connect to vertices containing that item in the next clique
-                    }
-                }
-                for (const auto & it : cliques[a+1]) {
-                    if (isItemIn(it, cliques[a]) && !isItemIn(it, selection)) {
-                        ///< if an item exists in the current clique but not in our vertex
-                        exclude.push_back(it);  ///< then we cannot connect to vertices containing that item in the next clique
-                    }
+LayeredGraph TemporalBPData::buildGraph(){
+    return buildGraphFromCliques(getMaxCliqueSet(), false);
+}
+
+/**
+ * Builds the graph with one column per clique.
+ * Combinations of all cliques are enumerated concurrently, then every column is linked to the next one
+ * concurrently, and the columns are finally assembled in chronological order
+ */
+LayeredGraph TemporalBPData::buildGraphFromCliques(const CliqueSet & cliques, bool reduced){
+    TBP_PROFILE_SCOPE("buildGraph");
+    const int nbCliques = cliques.getNbCliques();
+    CliqueCombos state;
+    state._reduced = reduced;
+    state._cliques = cliques;
+    state._combos.resize(nbCliques);
+    if (_buildOptions._dominancePruning) {
+        state._plainCombos.resize(nbCliques);
+        state._nbDominatedVertices.assign(nbCliques, 0);
+        state._nbDominatedArcs.assign(nbCliques, 0);
+    }
+    ///< the columns only live until they are assembled, their buffers go back all at once with the arena
+    MonotonicArena arena;
+    vector<GraphColumn> columns(nbCliques + 2, GraphColumn(_buildOptions._useArena ? &arena : nullptr));   ///< the start, one column per clique and the sink, in chronological order
+    TBP_PROFILE_ONLY(_columnStats.assign(nbCliques, ColumnStats()));
+
+    buildColumns(state, columns, 0, nbCliques);
+    finishColumns(state, columns);
+    if (_buildOptions._incremental)
+        _cliqueCombos = move(state);
+    else
+        _cliqueCombos = CliqueCombos();
+    _cliqueCombos._reduced = reduced;
+
+    ///< columns are stored chronologically, the vertex IDs follow that order
+    TBP_PROFILE_SCOPE("buildGraph.assemble");
+    LayeredGraph graph;
+    graph.assemble(columns);
+    TBP_PROFILE_COUNT("buildGraph.arenaAllocations", arena.getNbAllocations());
+    TBP_PROFILE_COUNT("buildGraph.arenaBytes", arena.getNbReservedBytes());
+    return graph;
+}
+
+static void addVertices(const FeasibleCombos & combos, GraphColumn & column){
+    ///< sized once, a buffer of the arena is not reused when it grows
+    size_t nbItems = column._items.size();
+    for (int c=0; c<combos.size(); c++)
+        nbItems += combos.getNbItems(c);
+    column._items.reserve(nbItems);
+    column._itemOffsets.reserve(column._itemOffsets.size() + combos.size());
+    for (int c=0; c<combos.size(); c++) {
+        combos.appendItems(c, column._items);
+        column._itemOffsets.push_back(column._items.size());
+    }
+}
+
+void TemporalBPData::buildColumns(CliqueCombos & state, vector<GraphColumn> & columns, int first, int last){
+    const CliqueSet & cliques = state._cliques;
+    const int nbCliques = cliques.getNbCliques();
+    vector<FeasibleCombos> & combos = state._combos;
+    vector<FeasibleCombos> & plainCombos = state._plainCombos;
+    ///< a clique whose plain combinations are kept lost some to the pruning
+    auto isPruned = [&](int a){ return !plainCombos.empty() && plainCombos[a].size() > 0; };
+
+    ///< for each feasible combination of items in a clique, we create a vertex
+    {
+        TBP_PROFILE_SCOPE("buildGraph.combos");
+        parallelFor(last - first, _buildOptions._nbWorkers, [&](int t){
+            const int a = first + t;
+            TBP_PROFILE_ONLY(auto start = chrono::steady_clock::now());
+            ComboEnumerator enumerator(_items, _capacity, cliques.getClique(a));
+            combos[a] = enumerator.enumerate();
+            if (_buildOptions._dominancePruning) {
+                vector<char> isLocal(combos[a].getNbItems());
+                bool hasLocal = false;
+                for (int k=0; k<combos[a].getNbItems(); k++) {
+                    const int & item = combos[a]._items[k];
+                    isLocal[k] = !(a > 0 && binary_search(cliques.begin(a-1), cliques.end(a-1), item))
+                              && !(a < nbCliques-1 && binary_search(cliques.begin(a+1), cliques.end(a+1), item));
+                    hasLocal = hasLocal || isLocal[k];
                 }
-                ///< We create an arc connecting to any vertex that respects our inclusion and exclusion requirements in the next clique
-                for (Vertex v : graph[graph.size()-1]) {
-                    if (isSuccessor(v, include, exclude)) {
-                        vector<int> new_items; ///< we check what items are new between u and v to add them to the arc
-                        for (const auto & it : v._items) {
-                            if (!isItemIn(it, u._items)) {
-                                new_items.push_back(it);
-                            }
-                        }
-                        Arc toNext = {v._id, new_items};
-                        u._arcs.push_back(toNext);
-                    }
+                plainCombos[a] = FeasibleCombos();
+                if (hasLocal) {
+                    plainCombos[a] = combos[a];
+                    if (combos[a].removeDominated(isLocal) == 0)
+                        plainCombos[a] = FeasibleCombos();
                 }
+                state._nbDominatedVertices[a] = isPruned(a) ? plainCombos[a].size() - combos[a].size() : 0;
             }
-            if (a==0) { ///< any vertex constructed in the first clique connects to the start
-                Arc fromStart = {u._id, u._items};
-                start._arcs.push_back(fromStart);
+            addVertices(combos[a], columns[a+1]);
+            TBP_PROFILE_ONLY(
+                ColumnStats & stats = _columnStats[a];
+                stats._width = cliques.getSize(a);
+                stats._nbCombos = combos[a].size();
+                stats._nbChecks = enumerator.getNbChecks();
+                stats._combosMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            )
+        });
+    }
+    if (first > 0)      ///< its vertices stay, its arcs lead to new vertices
+        addVertices(combos[first-1], columns[first]);
+    if (last < nbCliques && (last == 0 || !_buildOptions._indexedLinking))   ///< the start links to the first clique
+        addVertices(combos[last], columns[last+1]);
+
+    ///< arcs only need the vertices of the next column, so every column is linked independently
+    {
+        TBP_PROFILE_SCOPE("buildGraph.link");
+        const int firstLinked = max(first - 1, 0);
+        parallelFor(max(last - firstLinked, 0), _buildOptions._nbWorkers, [&](int t){
+            const int a = firstLinked + t;
+            TBP_PROFILE_ONLY(auto start = chrono::steady_clock::now());
+            const bool indexed = _buildOptions._indexedLinking && a < nbCliques-1;
+            if (indexed)
+                linkIndexed(combos[a], combos[a+1], columns[a+1]);
+            else
+                linkColumn(cliques, a, columns[a+1], columns[a+2]);
+            if (_buildOptions._dominancePruning) {
+                long plainNbArcs;
+                if (a < nbCliques-1 && (isPruned(a) || isPruned(a+1)))
+                    plainNbArcs = countLinks(isPruned(a) ? plainCombos[a] : combos[a],
+                                             isPruned(a+1) ? plainCombos[a+1] : combos[a+1]);
+                else
+                    plainNbArcs = columns[a+1].getNbArcs() + state._nbDominatedVertices[a];
+                state._nbDominatedArcs[a] = plainNbArcs - columns[a+1].getNbArcs();
             }
-            column.push_back(u);
-            nbVertices++;
+            TBP_PROFILE_ONLY(
+                const GraphColumn & column = columns[a+1];
+                ColumnStats & stats = _columnStats[a];
+                stats._nbArcs = column.getNbArcs();
+                ///< the index only visits successors, the scan tries every vertex of the next clique
+                stats._nbCandidates = indexed || a == nbCliques-1 ? column.getNbArcs()
+                                                                  : (long)column.getNbVertices() * combos[a+1].size();
+                stats._linkMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                stats._bytes = combos[a]._masks.capacity() * sizeof(uint64_t)
+                             + (column._items.capacity() + column._itemOffsets.capacity() + column._arcOffsets.capacity()
+                               + column._arcTargets.capacity() + column._arcItemOffsets.capacity()
+                               + column._arcItems.capacity()) * sizeof(int);
+            )
+        });
+    }
+}
+
+void TemporalBPData::finishColumns(const CliqueCombos & state, vector<GraphColumn> & columns){
+    const int nbCliques = state._cliques.getNbCliques();
+    columns[nbCliques + 1].closeVertex();   ///< the sink vertex alone in the final column of our graph
+
+    GraphColumn & start = columns[0];       ///< the start vertex connects to every vertex of the first clique
+    if (nbCliques > 0) {
+        const GraphColumn & first = columns[1];
+        for (int v=0; v<first.getNbVertices(); v++) {
+            start._arcItems.insert(start._arcItems.end(),
+                                   first._items.begin() + first._itemOffsets[v],
+                                   first._items.begin() + first._itemOffsets[v+1]);
+            start.closeArc(v);
         }
-        graph.push_back(column);
     }
-    start._id = nbVertices;
-    vector<Vertex> firstColumn; ///< Finally, we add the start vertex to our graph in the first column
-    firstColumn.push_back(start);
-    graph.push_back(firstColumn);
-    nbVertices++;
-
-    _maxNbCombosClique = maxNbCombosClique;
-
-    ///< we reverse the order of our graph so the columns are chronologically aligned
-        //< and we assign the chronologically correct IDs to vertices
-
-    int id = 0;
-    for (int c=graph.size()-1; c>=0; c--) {
-        for (int v=graph[c].size()-1; v>=0; v--) {
-            graph[c][v]._id = nbVertices - graph[c][v]._id -1;
-            for (int a=0; a<graph[c][v]._arcs.size(); a++) {
-                graph[c][v]._arcs[a]._successorId = nbVertices - graph[c][v]._arcs[a]._successorId -1;
+    start.closeVertex();
+
+    _maxNbCombosClique = 0;
+    for (const auto & clique : state._combos) {
+        _maxNbCombosClique = max(_maxNbCombosClique, clique.size());
+    }
+
+    _nbDominatedVertices = 0;
+    _nbDominatedArcs = 0;
+    for (int a=0; a<(int)state._nbDominatedVertices.size(); a++) {
+        _nbDominatedVertices += state._nbDominatedVertices[a];
+        _nbDominatedArcs += state._nbDominatedArcs[a];
+    }
+    if (!state._nbDominatedVertices.empty())   ///< arcs leaving the start
+        _nbDominatedArcs += state._nbDominatedVertices[0];
+}
+
+/**
+ * Creates the arcs of the vertices of column a+1 (clique a) towards column a+2 (clique a+1)
+ * by testing every pair of vertices
+ */
+void TemporalBPData::linkColumn(const CliqueSet & cliques, int a, GraphColumn & column, const GraphColumn & next) const {
+    const int nbCliques = cliques.getNbCliques();
+    vector<int> exclude;   ///< vertices containing these items should be excuded
+    vector<int> include;   ///< vertices containing these items should be incuded
+    ///< successors of every vertex found first, so that the arrays of the column are sized once, as in linkIndexed
+    vector<int> successorOffsets(1, 0);
+    vector<int> successors;
+    size_t nbArcItems = 0;
+    for (int u=0; u<column.getNbVertices(); u++) {
+        const int * uBegin = column._items.data() + column._itemOffsets[u];
+        const int * uEnd = column._items.data() + column._itemOffsets[u+1];
+        if (a==nbCliques-1) {  ///< any vertex constructed in the last clique connects to the sink
+            successors.push_back(0);
+        }else{  ///< otherwise that vertex must connect to a vertex in the next clique
+            include.clear();
+            exclude.clear();
+            for (const int * it = uBegin; it != uEnd; it++) {
+                if (isItemIn(*it, cliques.begin(a+1), cliques.end(a+1))) {
+                    ///< if an item in our vertex exist in the next clique
+                    include.push_back(*it);  ///< then we can only connect to vertices containing that item in the next clique
+                }
+            }
+            for (const int * it = cliques.begin(a+1); it != cliques.end(a+1); it++) {
+                if (isItemIn(*it, cliques.begin(a), cliques.end(a)) && !isItemIn(*it, uBegin, uEnd)) {
+                    ///< if an item exists in the current clique but not in our vertex
+                    exclude.push_back(*it);  ///< then we cannot connect to vertices containing that item in the next clique
+                }
+            }
+            ///< We create an arc connecting to any vertex that respects our inclusion and exclusion requirements in the next clique
+            for (int v=0; v<next.getNbVertices(); v++) {
+                const int * vBegin = next._items.data() + next._itemOffsets[v];
+                const int * vEnd = next._items.data() + next._itemOffsets[v+1];
+                if (isSuccessor(vBegin, vEnd, include, exclude)) {
+                    successors.push_back(v);
+                    ///< the items v shares with u are those of include, the others are new
+                    nbArcItems += (vEnd - vBegin) - include.size();
+                }
             }
-            reverse(graph[c][v]._arcs.begin(), graph[c][v]._arcs.end());
-            id++;
         }
-        reverse(graph[c].begin(), graph[c].end());
+        successorOffsets.push_back(successors.size());
     }
-    reverse(graph.begin(), graph.end());
-/*
-    if (id!=nbVertices) {
-        cout << "Error, unexpected number of vertices" << endl;
+    column._arcOffsets.reserve(column._arcOffsets.size() + column.getNbVertices());
+    column._arcTargets.reserve(column._arcTargets.size() + successors.size());
+    column._arcItemOffsets.reserve(column._arcItemOffsets.size() + successors.size());
+    column._arcItems.reserve(column._arcItems.size() + nbArcItems);
+
+    for (int u=0; u<column.getNbVertices(); u++) {
+        const int * uBegin = column._items.data() + column._itemOffsets[u];
+        const int * uEnd = column._items.data() + column._itemOffsets[u+1];
+        for (int s=successorOffsets[u]; s<successorOffsets[u+1]; s++) {
+            const int & v = successors[s];
+            if (a < nbCliques-1) {
+                for (const int * it = next._items.data() + next._itemOffsets[v]; it != next._items.data() + next._itemOffsets[v+1]; it++) {
+                    ///< the items that are new between u and v go on the arc
+                    if (!isItemIn(*it, uBegin, uEnd)) {
+                        column._arcItems.push_back(*it);
+                    }
+                }
+            }
+            column.closeArc(v);
+        }
+        column._arcOffsets.push_back(column._arcTargets.size());
     }
-*/
-
-    return graph;
 }
 
 
 
 vector<vector<int>> TemporalBPData::getReducedCliques()
 {
+    TBP_PROFILE_SCOPE("getReducedCliques");
     vector<vector<int>> cliques = getMaxCliques();
     //for (int a=cliques.size()-1; a>=1; a--) {
     for (int a=1; a<cliques.size(); a++) {
@@ -316,112 +538,8 @@ vector<vector<int>> TemporalBPData::getReducedCliques()
     return cliques;
 }
 
-vector<vector<Vertex>> TemporalBPData::buildReducedGraph(){
-    cout << "here";
-    vector<vector<int>> reducedCliques = getReducedCliques();
-
-    int maxNbCombosClique = 0;
-    vector<vector<Vertex>> graph;
-    Vertex start;
-    int nbVertices = 0;
-    Vertex sink;
-    sink._id = nbVertices;
-    vector<Vertex> sinkColumn;  ///< First we create the sink vertex and put it in the final column of our graph
-    sinkColumn.push_back(sink);
-    graph.push_back(sinkColumn);
-
-    nbVertices++;
-    ///< We iterate over all maximum cliques from last to first, each clique corresponding to a column in our graph
-    for (int a=reducedCliques.size()-1; a>=0; a--) {
-        vector<vector<int>> combos = getFeasibleCombinations(reducedCliques[a]);
-        if (combos.size() > maxNbCombosClique)
-        {
-            maxNbCombosClique = combos.size();
-        }
-        
-        vector<Vertex> column;
-        for (int c=combos.size()-1; c>=0; c--) {
-            vector<int> selection = combos[c];
-            Vertex u;   ///< for each feasible combination of items in a clique, we create a vertex
-            u._items = selection;
-            u._id = nbVertices;
-            if (a==reducedCliques.size()-1) {  ///< any vertex constructed in the last clique connects to the sink
-                Arc toSink = {sink._id};
-                u._arcs.push_back(toSink);
-            }else{  ///< otherwise that vertex must connect to a vertex in the next clique (previous clique in our exploration order)
-                ///< We create an arc connecting to any vertex in the next clique
-                /*for (Vertex v : graph[graph.size()-1]) {
-                    Arc toNext = {v._id, v._items};
-                    u._arcs.push_back(toNext);
-                }*/
-                vector<int> exclude;   ///< vertices containing these items should be excuded
-                vector<int> include;   ///< vertices containing these items should be incuded
-                for (const auto & it : selection) {
-                    if (isItemIn(it, reducedCliques[a+1])) {
-                        ///< if an item in our vertex exist in the next clique
-                        include.push_back(it);  ///< then we can only connect to vertices containing that item in the next clique
-                    }
-                }
-                for (const auto & it : reducedCliques[a+1]) {
-                    if (isItemIn(it, reducedCliques[a]) && !isItemIn(it, selection)) {
-                        ///< if an item exists in the current clique but not in our vertex
-                        exclude.push_back(it);  ///< then we cannot connect to vertices containing that item in the next clique
-                    }
-                }
-                ///< We create an arc connecting to any vertex that respects our inclusion and exclusion requirements in the next clique
-                for (Vertex v : graph[graph.size()-1]) {
-                    if (isSuccessor(v, include, exclude)) {
-                        vector<int> new_items; ///< we check what items are new between u and v to add them to the arc
-                        for (const auto & it : v._items) {
-                            if (!isItemIn(it, u._items)) {
-                                new_items.push_back(it);
-                            }
-                        }
-                        Arc toNext = {v._id, new_items};
-                        u._arcs.push_back(toNext);
-                    }
-                }
-            }
-            if (a==0) { ///< any vertex constructed in the first clique connects to the start
-                Arc fromStart = {u._id, u._items};
-                start._arcs.push_back(fromStart);
-            }
-            column.push_back(u);
-            nbVertices++;
-        }
-        graph.push_back(column);
-    }
-    start._id = nbVertices;
-    vector<Vertex> firstColumn; ///< Finally, we add the start vertex to our graph in the first column
-    firstColumn.push_back(start);
-    graph.push_back(firstColumn);
-    nbVertices++;
-
-    _maxNbCombosClique = maxNbCombosClique;
-
-    ///< we reverse the order of our graph so the columns are chronologically aligned
-        //< and we assign the chronologically correct IDs to vertices
-
-    int id = 0;
-    for (int c=graph.size()-1; c>=0; c--) {
-        for (int v=graph[c].size()-1; v>=0; v--) {
-            graph[c][v]._id = nbVertices - graph[c][v]._id -1;
-            for (int a=0; a<graph[c][v]._arcs.size(); a++) {
-                graph[c][v]._arcs[a]._successorId = nbVertices - graph[c][v]._arcs[a]._successorId -1;
-            }
-            reverse(graph[c][v]._arcs.begin(), graph[c][v]._arcs.end());
-            id++;
-        }
-        reverse(graph[c].begin(), graph[c].end());
-    }
-    reverse(graph.begin(), graph.end());
-/*
-    if (id!=nbVertices) {
-        cout << "Error, unexpected number of vertices" << endl;
-    }
-*/
-
-    return graph;
+LayeredGraph TemporalBPData::buildReducedGraph(){
+    return buildGraphFromCliques(CliqueSet(getReducedCliques()), true);
 }
 
 
@@ -429,13 +547,146 @@ vector<vector<Vertex>> TemporalBPData::buildReducedGraph(){
 
 
 
+int TemporalBPData::getUpperBound() const {
+    return solveFirstFit(*this)._nbBins;
+}
+
 int TemporalBPData::getVertexYPos(int vertexId, int column){
-    for (int v = 0; v < _graph[column].size(); v++)
-    {
-        if (_graph[column][v]._id == vertexId){
-            return v;
+    if (vertexId < 0 || vertexId >= _graph.getNbVertices() || _graph.getColumnOf(vertexId) != column)
+        return -1;
+    return _graph.getRowOf(vertexId);
+}
+
+
+
+int TemporalBPData::addItem(int size, int entry, int exit){
+    ///< after the items entering at the same date, as if it had been read last
+    auto position = upper_bound(_items.begin(), _items.end(), entry,
+                                [](int date, const Item & item){ return date < item._entry; });
+    const int id = position - _items.begin();
+    _items.insert(position, Item(-1, size, entry, exit));
+    renumberItems(_items.size() - 1);
+    return id;
+}
+
+bool TemporalBPData::removeItem(int id){
+    if (id < 0 || id >= getNbItems()) return false;
+    _items.erase(_items.begin() + id);
+    renumberItems(_items.size() + 1);
+    return true;
+}
+
+int TemporalBPData::updateItem(int id, int size, int entry, int exit){
+    if (id < 0 || id >= getNbItems()) return -1;
+    if (exit <= _items[id]._entry || _items[id]._exit <= entry) {
+        ///< the cliques between the former and the new dates do not change, two updates rebuild only the cliques around them
+        removeItem(id);
+        return addItem(size, entry, exit);
+    }
+    _items.erase(_items.begin() + id);
+    auto position = upper_bound(_items.begin(), _items.end(), entry,
+                                [](int date, const Item & item){ return date < item._entry; });
+    const int newId = position - _items.begin();
+    _items.insert(position, Item(-1, size, entry, exit));
+    renumberItems(_items.size());
+    return newId;
+}
+
+void TemporalBPData::renumberItems(int nbOldItems){
+    vector<int> oldToNew(nbOldItems, -1);
+    for (int i = 0; i < getNbItems(); i++) {
+        if (_items[i]._id >= 0)
+            oldToNew[_items[i]._id] = i;
+        _items[i]._id = i;
+    }
+    updateGraph(oldToNew);
+}
+
+/**
+ * Erases the entries [first, oldLast) of a vector and puts nbNew empty ones in their place
+ */
+template <class T>
+static void replaceRange(vector<T> & values, int first, int oldLast, int nbNew){
+    values.erase(values.begin() + first, values.begin() + oldLast);
+    values.insert(values.begin() + first, nbNew, T());
+}
+
+static void renumber(vector<int> & ids, const vector<int> & oldToNew){
+    for (auto & id : ids)
+        id = oldToNew[id];
+}
+
+void TemporalBPData::updateGraph(const vector<int> & oldToNew){
+    if (getNbColumns() == 0) return;    ///< the items have no graph
+    CliqueCombos & state = _cliqueCombos;
+    if (state.isEmpty()) {
+        createGraph(state._reduced);
+        return;
+    }
+    TBP_PROFILE_SCOPE("updateGraph");
+
+    CliqueSet cliques = state._reduced ? CliqueSet(getReducedCliques()) : getMaxCliqueSet();
+    const CliqueSet & oldCliques = state._cliques;
+    const int nbOld = oldCliques.getNbCliques();
+    const int nbNew = cliques.getNbCliques();
+    auto isSame = [&](int oldClique, int newClique){
+        if (oldCliques.getSize(oldClique) != cliques.getSize(newClique)) return false;
+        const int * it = cliques.begin(newClique);
+        for (const int * old = oldCliques.begin(oldClique); old != oldCliques.end(oldClique); old++, it++)
+            if (oldToNew[*old] != *it) return false;
+        return true;
+    };
+    int nbSameFirst = 0;
+    while (nbSameFirst < min(nbOld, nbNew) && isSame(nbSameFirst, nbSameFirst))
+        nbSameFirst++;
+    int nbSameLast = 0;
+    while (nbSameLast < min(nbOld, nbNew) - nbSameFirst && isSame(nbOld-1-nbSameLast, nbNew-1-nbSameLast))
+        nbSameLast++;
+    if (_buildOptions._dominancePruning) {  ///< the local items of a clique depend on its neighbours
+        nbSameFirst = max(nbSameFirst - 1, 0);
+        nbSameLast = max(nbSameLast - 1, 0);
+    }
+    const int first = nbSameFirst;
+    const int last = nbNew - nbSameLast;
+    const int oldLast = nbOld - nbSameLast;
+
+    ///< IDs only move from the first item that changed on, the columns of the cliques before it keep theirs
+    int firstMoved = 0;
+    while (firstMoved < (int)oldToNew.size() && oldToNew[firstMoved] == firstMoved)
+        firstMoved++;
+    auto hasMoved = [&](int a){ return a >= 0 && a < nbOld && oldCliques.getSize(a) > 0 && oldCliques.end(a)[-1] >= firstMoved; };
+    vector<int> renumbered;     ///< kept columns holding items that moved, the arcs holding items of the next clique
+    for (int a = -1; a < nbOld; a++) {
+        if ((a >= first && a < oldLast) || !(hasMoved(a) || hasMoved(a+1))) continue;
+        if (a >= 0 && hasMoved(a)) {
+            renumber(state._combos[a]._items, oldToNew);
+            if (!state._plainCombos.empty())
+                renumber(state._plainCombos[a]._items, oldToNew);
         }
+        if (a != first - 1)     ///< that column is linked again
+            renumbered.push_back(a < first ? a + 1 : a + 1 + last - oldLast);
     }
-    return -1;
-    
+
+    replaceRange(state._combos, first, oldLast, last - first);
+    if (_buildOptions._dominancePruning) {
+        replaceRange(state._plainCombos, first, oldLast, last - first);
+        replaceRange(state._nbDominatedVertices, first, oldLast, last - first);
+        replaceRange(state._nbDominatedArcs, first, oldLast, last - first);
+    }
+    TBP_PROFILE_ONLY(
+        if ((int)_columnStats.size() == nbOld)
+            replaceRange(_columnStats, first, oldLast, last - first);
+        else
+            _columnStats.assign(nbNew, ColumnStats());
+    )
+    state._cliques = move(cliques);
+
+    MonotonicArena arena;
+    vector<GraphColumn> columns(nbNew + 2, GraphColumn(_buildOptions._useArena ? &arena : nullptr));
+    buildColumns(state, columns, first, last);
+    finishColumns(state, columns);
+    ///< the columns of cliques [first-1, last) change, the start standing for clique -1
+    _graph.replaceColumns(first, oldLast + 1, columns.data() + first, last + 1 - first);
+    for (const auto & column : renumbered)
+        _graph.renumberItems(column, oldToNew);
 }
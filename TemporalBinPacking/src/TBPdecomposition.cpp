@@ -0,0 +1,160 @@
+//
+// Created by lhirwashema on 2022-07-30.
+//
+
+#include "../include/TBPdecomposition.hpp"
+#include "../include/TBPaggregation.hpp"
+#include "../include/TBPbounds.hpp"
+#include "../include/TBPevents.hpp"
+#include "../include/TBPparallel.hpp"
+#include "../include/TBPprofile.hpp"
+#include <chrono>
+
+using namespace std;
+
+static double elapsedMs(chrono::steady_clock::time_point start){
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+vector<int> getTimeComponents(const vector<Item> & items){
+    vector<int> offsets(1, 0);
+    int lastExit = 0;
+    for (int i = 0; i < (int)items.size(); i++) {
+        ///< an item leaves before an entry at its exit date, as in isFeasible
+        if (i > 0 && items[i]._entry >= lastExit)
+            offsets.push_back(i);
+        lastExit = i > 0 ? max(lastExit, items[i]._exit) : items[i]._exit;
+    }
+    if (!items.empty())
+        offsets.push_back(items.size());
+    return offsets;
+}
+
+TemporalBPData extractComponent(const TemporalBPData & data, int first, int last){
+    ///< the items are already in entry order, sorting them again could swap items entering at the same date
+    TemporalBPData component(data.getCapacity(), vector<Item>());
+    component._items.assign(data._items.begin() + first, data._items.begin() + last);
+    for (auto & item : component._items)
+        item._id -= first;
+    component._buildOptions = data._buildOptions;
+    component._buildOptions._nbWorkers = 1;
+    component._buildOptions._incremental = false;
+    return component;
+}
+
+long DecomposedSolution::getNbVertices() const {
+    long nbVertices = 0;
+    for (const auto & component : _components)
+        nbVertices += component._nbVertices;
+    return nbVertices;
+}
+
+long DecomposedSolution::getNbArcs() const {
+    long nbArcs = 0;
+    for (const auto & component : _components)
+        nbArcs += component._nbArcs;
+    return nbArcs;
+}
+
+long DecomposedSolution::getMaxGraphBytes() const {
+    long graphBytes = 0;
+    for (const auto & component : _components)
+        graphBytes = max(graphBytes, component._graphBytes);
+    return graphBytes;
+}
+
+bool DecomposedSolution::isOverBudget() const {
+    for (const auto & component : _components)
+        if (component._graph == GRAPH_NONE) return true;
+    return false;
+}
+
+DecomposedSolution solveByComponents(const TemporalBPData & data, bool reduced, int nbWorkers, bool aggregate, bool events){
+    TBP_PROFILE_SCOPE("decomposition");
+    const vector<int> offsets = getTimeComponents(data._items);
+    const int nbComponents = offsets.size() - 1;
+    TBP_PROFILE_COUNT("decomposition.components", nbComponents);
+    DecomposedSolution decomposed;
+    decomposed._components.resize(nbComponents);
+
+    ///< bounds first, the largest lower bound tells which components are worth a graph
+    vector<TBPBounds> bounds(nbComponents);
+    parallelFor(nbComponents, nbWorkers, [&](int k){
+        ComponentResult & result = decomposed._components[k];
+        result._first = offsets[k];
+        result._last = offsets[k + 1];
+        bounds[k] = computeBounds(extractComponent(data, result._first, result._last));
+    });
+    int lowerBound = 0;
+    for (const auto & componentBounds : bounds)
+        lowerBound = max(lowerBound, componentBounds._lowerBound);
+
+    parallelFor(nbComponents, nbWorkers, [&](int k){
+        ComponentResult & result = decomposed._components[k];
+        result._closedByBounds = bounds[k].getUpperBound() <= lowerBound;
+        if (result._closedByBounds) {
+            result._solution = bounds[k]._firstFit;
+            return;
+        }
+        TemporalBPData component = extractComponent(data, result._first, result._last);
+        bool componentReduced = reduced && !events;
+        result._graph = events ? GRAPH_EVENTS : reduced ? GRAPH_REDUCED : GRAPH_NORMAL;
+        if (component._buildOptions._graphBudgetKb > 0 && !events) {
+            auto start = chrono::steady_clock::now();
+            result._graph = chooseGraph(component, reduced, component._buildOptions._graphBudgetKb);
+            result._graphMs = elapsedMs(start);
+            componentReduced = result._graph == GRAPH_REDUCED;
+            if (result._graph == GRAPH_NONE) {
+                result._solution = bounds[k]._firstFit;
+                return;
+            }
+        }
+        if ((aggregate || result._graph == GRAPH_AGGREGATED) && !componentReduced && !events) {
+            AggregationAttempt attempt = trySolveAggregated(component, lowerBound);
+            result._graphMs += attempt._graphMs;
+            result._solveMs = attempt._solveMs;
+            const bool better = !attempt._solution._binOfItem.empty() && attempt._solution._nbBins < bounds[k].getUpperBound();
+            if (attempt._solved || result._graph == GRAPH_AGGREGATED) {   ///< no graph of the items: the better of the greedy and the first fit
+                result._graph = GRAPH_AGGREGATED;
+                result._nbColumns = attempt._nbColumns;
+                result._nbVertices = attempt._nbVertices;
+                result._nbArcs = attempt._nbArcs;
+                result._graphBytes = attempt._graphBytes;
+                result._solution = attempt._solved || better ? attempt._solution : bounds[k]._firstFit;
+                return;
+            }
+            if (better)
+                bounds[k]._firstFit = attempt._solution;   ///< starting solution of the solver below
+        }
+        auto start = chrono::steady_clock::now();
+        if (events)
+            component._graph = buildEventGraph(component);
+        else
+            component.createGraph(componentReduced);
+        result._graphMs += elapsedMs(start);
+        result._nbColumns = component.getNbColumns();
+        result._nbVertices = component._graph.getNbVertices();
+        result._nbArcs = component._graph.getNbArcs();
+        for (int a = 0; a < NB_GRAPH_ARRAYS; a++)
+            result._graphBytes += component._graph.getArray(GraphArray(a)).size() * sizeof(int);
+
+        start = chrono::steady_clock::now();
+        TBPSolver solver(component);
+        result._solution = solver.solve(bounds[k]);
+        if (componentReduced)   ///< a relaxation, only its bound is kept if it is not valid
+            result._solution = checkRelaxedSolution(component, result._solution, bounds[k]._firstFit);
+        result._solveMs += elapsedMs(start);
+    });
+
+    TBPSolution & solution = decomposed._solution;
+    solution._binOfItem.assign(data.getNbItems(), -1);
+    solution._lowerBound = lowerBound;
+    for (const auto & result : decomposed._components) {
+        solution._nbBins = max(solution._nbBins, result._solution._nbBins);
+        solution._lowerBound = max(solution._lowerBound, result._solution._lowerBound);
+        for (int i = result._first; i < result._last; i++)
+            solution._binOfItem[i] = result._solution._binOfItem[i - result._first];
+    }
+    solution._optimal = solution._nbBins <= solution._lowerBound;
+    return decomposed;
+}
@@ -0,0 +1,177 @@
+//
+// Created by lhirwashema on 2022-08-04.
+//
+
+#include "../include/TBPestimate.hpp"
+#include "../include/TBPaggregation.hpp"
+#include "../include/TBPprofile.hpp"
+#include <algorithm>
+
+using namespace std;
+
+constexpr double GraphEstimate::FOOTPRINT_RATIO;
+
+double GraphEstimate::getGraphBytes() const {
+    ///< the arrays of LayeredGraph, in the order of GraphArray
+    const double nbInts = (getNbColumns() + 1)
+                        + (_nbVertices + 1) + _nbVertexItems
+                        + (_nbVertices + 1) + _nbArcs
+                        + (_nbArcs + 1) + _nbArcItems;
+    return nbInts * sizeof(int);
+}
+
+/**
+ * Subsets of a group of items by their total size w, up to the capacity: _counts[w] subsets holding _items[w] items
+ * in all. Once accumulated, they give the subsets of total size at most w
+ */
+class SizeDistribution {
+public:
+    vector<double> _counts;
+    vector<double> _items;
+
+    explicit SizeDistribution(int maxSum) : _counts(maxSum + 1, 0), _items(maxSum + 1, 0) { _counts[0] = 1; }
+
+    int getMaxSum() const { return _counts.size() - 1; }
+
+    /**
+     * Adds multiplicity interchangeable items of one size, any number of them being taken
+     */
+    void add(int size, int multiplicity){
+        if (multiplicity == 1) {   ///< taken or not, in place from the largest sums
+            for (int w = getMaxSum(); w >= size; w--) {
+                _items[w] += _items[w - size] + _counts[w - size];
+                _counts[w] += _counts[w - size];
+            }
+            return;
+        }
+        const vector<double> counts = _counts;
+        const vector<double> items = _items;
+        for (int w = 0; w <= getMaxSum(); w++)
+            for (int n = 1; n <= multiplicity && (long)n * size <= w; n++) {
+                _counts[w] += counts[w - n * size];
+                _items[w] += items[w - n * size] + n * counts[w - n * size];
+            }
+    }
+
+    void accumulate(){
+        for (int w = 1; w <= getMaxSum(); w++) {
+            _counts[w] += _counts[w - 1];
+            _items[w] += _items[w - 1];
+        }
+    }
+
+    /// once accumulated, subsets of total size at most sum
+    double getCount(long sum) const { return sum < 0 ? 0 : _counts[min<long>(sum, getMaxSum())]; }
+    double getItems(long sum) const { return sum < 0 ? 0 : _items[min<long>(sum, getMaxSum())]; }
+};
+
+/**
+ * Distribution of the subsets of some members of a clique, sums beyond the capacity being left out
+ */
+static SizeDistribution getDistribution(const vector<int> & members, const vector<int> & sizes,
+                                        const vector<int> & multiplicities, int capacity){
+    long total = 0;
+    for (const auto & m : members)
+        total += (long)sizes[m] * multiplicities[m];
+    SizeDistribution distribution(max(0L, min<long>(capacity, total)));
+    for (const auto & m : members)
+        distribution.add(sizes[m], multiplicities[m]);
+    return distribution;
+}
+
+GraphEstimate estimateGraph(const vector<int> & sizes, const vector<int> & multiplicities, int capacity, const CliqueSet & cliques){
+    TBP_PROFILE_SCOPE("estimateGraph");
+    const int nbCliques = cliques.getNbCliques();
+    GraphEstimate estimate;
+    estimate._cliques.resize(nbCliques);
+    vector<int> shared;
+    vector<int> onlyCurrent;
+    vector<int> onlyNext;
+    for (int a = 0; a < nbCliques; a++) {
+        shared.clear();
+        onlyCurrent.clear();
+        onlyNext.clear();
+        if (a + 1 < nbCliques) {
+            set_intersection(cliques.begin(a), cliques.end(a), cliques.begin(a + 1), cliques.end(a + 1), back_inserter(shared));
+            set_difference(cliques.begin(a), cliques.end(a), cliques.begin(a + 1), cliques.end(a + 1), back_inserter(onlyCurrent));
+            set_difference(cliques.begin(a + 1), cliques.end(a + 1), cliques.begin(a), cliques.end(a), back_inserter(onlyNext));
+        } else {   ///< the sink takes no item
+            onlyCurrent.assign(cliques.begin(a), cliques.end(a));
+        }
+        const SizeDistribution sharedSums = getDistribution(shared, sizes, multiplicities, capacity);
+        SizeDistribution currentSums = getDistribution(onlyCurrent, sizes, multiplicities, capacity);
+        SizeDistribution nextSums = getDistribution(onlyNext, sizes, multiplicities, capacity);
+        currentSums.accumulate();
+        nextSums.accumulate();
+
+        ///< a combination is its shared items of size w with items of this clique only of size at most C-w,
+        ///< its successors take the same shared items with items of the next clique only of size at most C-w
+        CliqueEstimate & clique = estimate._cliques[a];
+        for (int w = 0; w <= sharedSums.getMaxSum(); w++) {
+            const double & nbShared = sharedSums._counts[w];
+            if (nbShared == 0) continue;
+            const long left = (long)capacity - w;
+            const double nbCurrent = currentSums.getCount(left);
+            clique._nbCombos += nbShared * nbCurrent;
+            clique._nbItems += sharedSums._items[w] * nbCurrent + nbShared * currentSums.getItems(left);
+            clique._nbArcs += nbShared * nbCurrent * nextSums.getCount(left);
+            clique._nbArcItems += nbShared * nbCurrent * nextSums.getItems(left);
+        }
+        estimate._nbVertices += clique._nbCombos;
+        estimate._nbVertexItems += clique._nbItems;
+        estimate._nbArcs += clique._nbArcs;
+        estimate._nbArcItems += clique._nbArcItems;
+        estimate._maxNbCombosClique = max(estimate._maxNbCombosClique, clique._nbCombos);
+    }
+    estimate._nbVertices += 2;
+    if (nbCliques > 0) {   ///< the start connects to every combination of the first clique
+        estimate._nbArcs += estimate._cliques[0]._nbCombos;
+        estimate._nbArcItems += estimate._cliques[0]._nbItems;
+    }
+    return estimate;
+}
+
+GraphEstimate estimateGraph(TemporalBPData & data, bool reduced){
+    vector<int> sizes(data.getNbItems());
+    for (int i = 0; i < data.getNbItems(); i++)
+        sizes[i] = data._items[i]._size;
+    return estimateGraph(sizes, vector<int>(data.getNbItems(), 1), data.getCapacity(),
+                         reduced ? CliqueSet(data.getReducedCliques()) : data.getMaxCliqueSet());
+}
+
+GraphEstimate estimateAggregatedGraph(const TemporalBPData & data){
+    const ItemTypes types = groupIdenticalItems(data._items, data.getMaxCliqueSet());
+    vector<int> multiplicities(types.getNbTypes());
+    for (int t = 0; t < types.getNbTypes(); t++)
+        multiplicities[t] = types.getMultiplicity(t);
+    return estimateGraph(types._sizes, multiplicities, data.getCapacity(), types._cliques);
+}
+
+string getGraphChoiceName(GraphChoice choice){
+    switch (choice) {
+        case GRAPH_NORMAL: return "normal";
+        case GRAPH_REDUCED: return "reduced";
+        case GRAPH_AGGREGATED: return "aggregated";
+        case GRAPH_EVENTS: return "events";
+        default: return "none";
+    }
+}
+
+GraphChoice chooseGraph(TemporalBPData & data, bool reduced, long budgetKb, GraphEstimate * estimate){
+    GraphEstimate tried = estimateGraph(data, reduced);
+    GraphChoice choice = reduced ? GRAPH_REDUCED : GRAPH_NORMAL;
+    auto fits = [&](){ return budgetKb <= 0 || tried.getFootprintKb() <= budgetKb; };
+    if (!fits() && !reduced) {
+        tried = estimateGraph(data, true);
+        choice = GRAPH_REDUCED;
+    }
+    if (!fits()) {
+        tried = estimateAggregatedGraph(data);
+        choice = GRAPH_AGGREGATED;
+    }
+    if (!fits())
+        choice = GRAPH_NONE;
+    if (estimate != nullptr)
+        *estimate = tried;
+    return choice;
+}
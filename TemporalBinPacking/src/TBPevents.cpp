@@ -0,0 +1,198 @@
+//
+// Created by lhirwashema on 2022-08-06.
+//
+
+#include "../include/TBPevents.hpp"
+#include "../include/TBPprofile.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+
+using namespace std;
+
+vector<ItemEvent> getItemEvents(const vector<Item> & items){
+    ///< (date, order, item, exit of an item leaving as soon as it enters): exits first, then entries; an item leaving
+    ///< as soon as it enters is gone right after its entry, before the items entering after it at the same date,
+    ///< as isFeasible has it
+    vector<tuple<int, int, int, int>> keys;
+    keys.reserve(2 * items.size());
+    for (int i = 0; i < (int)items.size(); i++) {
+        keys.emplace_back(items[i]._entry, 1, i, 0);
+        if (items[i]._exit > items[i]._entry)
+            keys.emplace_back(items[i]._exit, 0, i, 0);
+        else
+            keys.emplace_back(items[i]._entry, 1, i, 1);
+    }
+    sort(keys.begin(), keys.end());
+    vector<ItemEvent> events;
+    events.reserve(keys.size());
+    for (const auto & key : keys)
+        events.push_back(ItemEvent(get<0>(key), get<1>(key) == 1 && get<3>(key) == 0, get<2>(key)));
+    return events;
+}
+
+/**
+ * Bins of one layer in CSR layout, items by increasing ID
+ */
+class EventLayer {
+public:
+    vector<int> _offsets;
+    vector<int> _items;
+    vector<int> _loads;
+
+    EventLayer() : _offsets(1, 0) {}
+
+    int size() const { return _loads.size(); }
+    const int * begin(int r) const { return _items.data() + _offsets[r]; }
+    const int * end(int r) const { return _items.data() + _offsets[r + 1]; }
+
+    void clear(){
+        _offsets.assign(1, 0);
+        _items.clear();
+        _loads.clear();
+    }
+
+    void close(int load){
+        _offsets.push_back(_items.size());
+        _loads.push_back(load);
+    }
+};
+
+/**
+ * FNV-1a hash of the items of a bin, skipping one of them
+ */
+static uint64_t hashBin(const int * begin, const int * end, int skipped){
+    uint64_t hash = 14695981039346656037ULL;
+    for (const int * it = begin; it != end; ++it) {
+        if (*it == skipped) continue;
+        hash ^= (uint32_t)*it;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Bins of the next layer by their items, to find where the bins holding an exiting item go once it is dropped
+ */
+class BinIndex {
+public:
+    void reset(int nbBins){
+        size_t size = 16;
+        while (size < 2 * (size_t)nbBins) size <<= 1;
+        _rows.assign(size, -1);
+    }
+
+    void insert(const EventLayer & layer, int row){
+        size_t slot = hashBin(layer.begin(row), layer.end(row), -1) & (_rows.size() - 1);
+        while (_rows[slot] != -1)
+            slot = (slot + 1) & (_rows.size() - 1);
+        _rows[slot] = row;
+    }
+
+    /**
+     * Row of the bin of layer holding the items [begin, end) but skipped
+     */
+    int find(const EventLayer & layer, const int * begin, const int * end, int skipped) const {
+        size_t slot = hashBin(begin, end, skipped) & (_rows.size() - 1);
+        const int length = end - begin - 1;
+        for (; _rows[slot] != -1; slot = (slot + 1) & (_rows.size() - 1)) {
+            const int row = _rows[slot];
+            if (layer.end(row) - layer.begin(row) != length) continue;
+            const int * it = layer.begin(row);
+            bool same = true;
+            for (const int * jt = begin; jt != end && same; ++jt)
+                if (*jt != skipped) same = *it++ == *jt;
+            if (same) return row;
+        }
+        return -1;
+    }
+
+private:
+    vector<int> _rows;   ///< open addressing, -1 for a free slot
+};
+
+LayeredGraph buildEventGraph(const vector<Item> & items, int capacity, int * maxNbVerticesColumn){
+    TBP_PROFILE_SCOPE("buildEventGraph");
+    const vector<ItemEvent> events = getItemEvents(items);
+    LayeredGraph graph;
+    EventLayer current;
+    EventLayer next;
+    BinIndex index;
+    GraphColumn column;   ///< bins of the current layer, with their arcs towards the next one
+    vector<int> rows;     ///< exit: row of each bin of the current layer in the next one
+    current.close(0);     ///< the empty bin of the start
+    int maxNbVertices = 1;
+
+    for (const auto & event : events) {
+        const int item = event._item;
+        column._itemOffsets.assign(1, 0);
+        column._items.clear();
+        column.clearArcs();
+        next.clear();
+        if (event._entry) {
+            ///< the next layer holds the bins skipping the item, then those packing it, in the same order;
+            ///< items enter by increasing ID, so the packed item goes last
+            const int size = items[item]._size;
+            for (int r = 0; r < current.size(); r++) {
+                next._items.insert(next._items.end(), current.begin(r), current.end(r));
+                next.close(current._loads[r]);
+            }
+            for (int r = 0; r < current.size(); r++) {
+                column._items.insert(column._items.end(), current.begin(r), current.end(r));
+                column.closeArc(r);
+                if (current._loads[r] + size <= capacity) {
+                    column._arcItems.push_back(item);
+                    column.closeArc(next.size());
+                    next._items.insert(next._items.end(), current.begin(r), current.end(r));
+                    next._items.push_back(item);
+                    next.close(current._loads[r] + size);
+                }
+                column.closeVertex();
+            }
+        } else {
+            ///< the bins without the item go on, the others merge with the bin they hold apart from it,
+            ///< which is in the layer since feasibility is hereditary
+            rows.assign(current.size(), -1);
+            for (int r = 0; r < current.size(); r++) {
+                if (binary_search(current.begin(r), current.end(r), item)) continue;
+                rows[r] = next.size();
+                next._items.insert(next._items.end(), current.begin(r), current.end(r));
+                next.close(current._loads[r]);
+            }
+            index.reset(next.size());
+            for (int r = 0; r < next.size(); r++)
+                index.insert(next, r);
+            for (int r = 0; r < current.size(); r++) {
+                if (rows[r] == -1)
+                    rows[r] = index.find(next, current.begin(r), current.end(r), item);
+                column._items.insert(column._items.end(), current.begin(r), current.end(r));
+                column.closeArc(rows[r]);
+                column.closeVertex();
+            }
+        }
+        graph.appendColumn(column);
+        swap(current, next);
+        maxNbVertices = max(maxNbVertices, current.size());
+    }
+
+    if (events.empty()) {   ///< no item: the start goes straight to the sink
+        column.closeArc(0);
+        column.closeVertex();
+        graph.appendColumn(column);
+    }
+    GraphColumn sink;   ///< the empty bin once every item left
+    for (int r = 0; r < current.size(); r++) {
+        sink._items.insert(sink._items.end(), current.begin(r), current.end(r));
+        sink.closeVertex();
+    }
+    graph.appendColumn(sink);
+    TBP_PROFILE_COUNT("eventGraph.vertices", graph.getNbVertices());
+    TBP_PROFILE_COUNT("eventGraph.arcs", graph.getNbArcs());
+    if (maxNbVerticesColumn != nullptr)
+        *maxNbVerticesColumn = maxNbVertices;
+    return graph;
+}
+
+LayeredGraph buildEventGraph(TemporalBPData & data){
+    return buildEventGraph(data._items, data.getCapacity(), &data._maxNbCombosClique);
+}
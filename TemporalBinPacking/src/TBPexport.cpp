@@ -0,0 +1,265 @@
+//
+// Created by lhirwashema on 2022-08-05.
+//
+
+#include "../include/TBPexport.hpp"
+#include "../include/TBPprofile.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+static const uint32_t EDGE_LIST_VERSION = 1;
+static const int DIMACS_WIDTH = 20;   ///< padded numbers of the DIMACS header
+
+ChunkedWriter::ChunkedWriter(size_t chunkSize) :
+    _fd(-1),
+    _ok(false),
+    _buffer(new char[max<size_t>(chunkSize, 64)]),
+    _chunkSize(max<size_t>(chunkSize, 64)),
+    _used(0),
+    _flushed(0){}
+
+ChunkedWriter::~ChunkedWriter(){
+    if (_fd >= 0)
+        ::close(_fd);
+    delete[] _buffer;
+}
+
+bool ChunkedWriter::open(const string & fileName, string & error){
+    _fileName = fileName;
+    _fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    _used = 0;
+    _flushed = 0;
+    _ok = _fd >= 0;
+    if (!_ok)
+        error = "cannot create " + fileName + ": " + strerror(errno);
+    return _ok;
+}
+
+void ChunkedWriter::flush(){
+    const char * p = _buffer;
+    size_t length = _used;
+    while (_ok && length > 0) {
+        ssize_t written = write(_fd, p, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            _ok = false;
+            break;
+        }
+        p += written;
+        length -= written;
+    }
+    _flushed += _used;
+    _used = 0;
+}
+
+bool ChunkedWriter::close(string & error){
+    if (_fd < 0) {
+        error = "no file open";
+        return false;
+    }
+    flush();
+    const bool closed = ::close(_fd) == 0;
+    _fd = -1;
+    if (!_ok || !closed) {
+        error = "cannot write " + _fileName + ": " + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void ChunkedWriter::putText(const char * text){
+    putBytes(text, strlen(text));
+}
+
+void ChunkedWriter::putInt(long value){
+    char digits[24];
+    int n = 0;
+    unsigned long magnitude = value < 0 ? -(unsigned long)value : value;
+    do {
+        digits[n++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+    reserve(n + 1);
+    if (value < 0)
+        _buffer[_used++] = '-';
+    while (n > 0)
+        _buffer[_used++] = digits[--n];
+}
+
+void ChunkedWriter::putBytes(const void * data, size_t size){
+    const char * p = static_cast<const char *>(data);
+    while (size > 0) {   ///< larger than a chunk: written through the buffer piece by piece
+        reserve(min(size, _chunkSize));
+        const size_t length = min(size, _chunkSize - _used);
+        memcpy(_buffer + _used, p, length);
+        _used += length;
+        p += length;
+        size -= length;
+    }
+}
+
+bool ChunkedWriter::patch(uint64_t offset, const void * data, size_t size){
+    flush();
+    const char * p = static_cast<const char *>(data);
+    while (_ok && size > 0) {
+        ssize_t written = pwrite(_fd, p, size, offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            _ok = false;
+            break;
+        }
+        p += written;
+        offset += written;
+        size -= written;
+    }
+    return _ok;
+}
+
+GraphExporter::GraphExporter(ExportFormat format, bool labels, long supply, size_t chunkSize) :
+    _format(format),
+    _labels(labels),
+    _supply(supply),
+    _writer(chunkSize),
+    _nbColumns(0),
+    _nbVertices(0),
+    _nbArcs(0),
+    _nbLabels(0),
+    _nbItems(0),
+    _headerOffset(0){}
+
+bool GraphExporter::open(const string & fileName, string & error){
+    if (!_writer.open(fileName, error))
+        return false;
+    _nbColumns = 0;
+    _nbVertices = 0;
+    _nbArcs = 0;
+    _nbLabels = 0;
+    _nbItems = 0;
+    writeHeader(false);
+    return true;
+}
+
+/**
+ * Writes the header, with the counts known so far. The final header has the same size and replaces the first one
+ */
+void GraphExporter::writeHeader(bool final){
+    if (_format == EXPORT_BINARY) {
+        EdgeListHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header._magic, "TBPE", 4);
+        header._version = EDGE_LIST_VERSION;
+        header._nbVertices = _nbVertices;
+        header._nbArcs = _nbArcs;
+        header._nbLabels = _nbLabels;
+        header._nbItems = _nbItems;
+        if (final) {
+            _writer.patch(_headerOffset, &header, sizeof(header));
+        } else {
+            _headerOffset = _writer.getOffset();
+            _writer.putBytes(&header, sizeof(header));
+        }
+        return;
+    }
+
+    if (!final) {
+        _writer.putText("c TBP layered graph: one unit of flow per bin, the arcs leaving the start cost one bin\n"
+                        "c each arc taking new items is followed by a line \"c l\" listing them\n");
+        _headerOffset = _writer.getOffset();
+    }
+    ///< problem line with the bypass arc, then the supplies of the start and the sink
+    const long supply = _supply > 0 ? _supply : _nbItems;
+    const unsigned long long nbArcs = _nbArcs + (_nbVertices > 0 ? 1 : 0);
+    char text[5 * DIMACS_WIDTH + 32];
+    snprintf(text, sizeof(text), "p min %*llu %*llu\nn 1 %*ld\nn %*llu %*ld\n",
+             DIMACS_WIDTH, (unsigned long long)_nbVertices, DIMACS_WIDTH, nbArcs,
+             DIMACS_WIDTH, supply, DIMACS_WIDTH, (unsigned long long)_nbVertices, DIMACS_WIDTH, -supply);
+    if (final) {
+        _writer.patch(_headerOffset, text, strlen(text));
+    } else {
+        _writer.putText(text);
+    }
+}
+
+void GraphExporter::writeArc(uint64_t tail, uint64_t head, const int * itemsBegin, const int * itemsEnd){
+    _nbArcs++;
+    _nbLabels += itemsEnd - itemsBegin;
+    for (const int * item = itemsBegin; item != itemsEnd; ++item)
+        _nbItems = max(_nbItems, *item + 1);
+
+    if (_format == EXPORT_BINARY) {
+        _writer.putInt32(tail);
+        _writer.putInt32(head);
+        _writer.putInt32(itemsEnd - itemsBegin);
+        _writer.putBytes(itemsBegin, (itemsEnd - itemsBegin) * sizeof(int));
+        return;
+    }
+    _writer.putText("a ");
+    _writer.putInt(tail + 1);
+    _writer.putChar(' ');
+    _writer.putInt(head + 1);
+    _writer.putText(" 0 ");
+    _writer.putInt(_supply > 0 ? _supply : INT_MAX);
+    _writer.putText(tail == 0 ? " 1\n" : " 0\n");
+    if (_labels && itemsBegin != itemsEnd) {
+        _writer.putText("c l");
+        for (const int * item = itemsBegin; item != itemsEnd; ++item) {
+            _writer.putChar(' ');
+            _writer.putInt(*item);
+        }
+        _writer.putChar('\n');
+    }
+}
+
+void GraphExporter::writeColumn(const GraphColumn & column){
+    TBP_PROFILE_SCOPE("export.column");
+    const uint64_t first = _nbVertices;
+    const uint64_t next = first + column.getNbVertices();
+    for (int r = 0; r < column.getNbVertices(); r++)
+        for (int a = column._arcOffsets[r]; a < column._arcOffsets[r + 1]; a++)
+            writeArc(first + r, next + column._arcTargets[a],
+                     column._arcItems.data() + column._arcItemOffsets[a],
+                     column._arcItems.data() + column._arcItemOffsets[a + 1]);
+    _nbVertices = next;
+    _nbColumns++;
+}
+
+void GraphExporter::writeGraph(const LayeredGraph & graph){
+    TBP_PROFILE_SCOPE("export.graph");
+    const int * pool = graph._arcItems.data();
+    for (int v = 0; v < graph.getNbVertices(); v++)
+        for (int a = graph._arcOffsets[v]; a < graph._arcOffsets[v + 1]; a++)
+            writeArc(v, graph._arcSuccessors[a], pool + graph._arcItemOffsets[a], pool + graph._arcItemOffsets[a + 1]);
+    _nbVertices += graph.getNbVertices();
+    _nbColumns += graph.getNbColumns();
+}
+
+bool GraphExporter::close(string & error){
+    if (_format == EXPORT_DIMACS && _nbVertices > 0) {   ///< the unused supply goes straight to the sink
+        _writer.putText("a 1 ");
+        _writer.putInt(_nbVertices);
+        _writer.putText(" 0 ");
+        _writer.putInt(_supply > 0 ? _supply : INT_MAX);
+        _writer.putText(" 0\n");
+    }
+    writeHeader(true);
+    return _writer.close(error);
+}
+
+bool exportGraph(const LayeredGraph & graph, const string & fileName, ExportFormat format, bool labels, string & error){
+    GraphExporter exporter(format, labels);
+    if (!exporter.open(fileName, error))
+        return false;
+    exporter.writeGraph(graph);
+    return exporter.close(error);
+}
+
+string getExportExtension(ExportFormat format){
+    return format == EXPORT_DIMACS ? ".min" : ".tbpe";
+}
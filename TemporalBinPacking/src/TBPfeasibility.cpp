@@ -0,0 +1,166 @@
+//
+// Created by lhirwashema on 2022-07-25.
+//
+
+#include "../include/TBPfeasibility.hpp"
+#include "../include/TBPdata.hpp"
+#include "../include/TBPprofile.hpp"
+
+#if defined(TBP_SIMD) && defined(__x86_64__) && defined(__GNUC__)
+#define TBP_FEASIBILITY_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static bool smallerId(const Item * i, const Item * j) {
+    return i->_id < j->_id;
+}
+
+FeasibilityKernel::FeasibilityKernel(const vector<Item> & items, int capacity, const vector<int> & clique) :
+    _capacity(capacity)
+{
+    vector<const Item *> cliqueItems;
+    for (const auto & itemId : clique)
+        cliqueItems.push_back(&items[itemId]);
+    init(cliqueItems);
+}
+
+FeasibilityKernel::FeasibilityKernel(const vector<const Item *> & cliqueItems, int capacity) :
+    _capacity(capacity)
+{
+    init(cliqueItems);
+}
+
+void FeasibilityKernel::init(vector<const Item *> sorted){
+    if (!is_sorted(sorted.begin(), sorted.end(), smallerId))     ///< IDs were assigned by increasing entry date
+        sort(sorted.begin(), sorted.end(), smallerId);
+    const int nbItems = sorted.size();
+    _nbWords = max(1, (nbItems + 63) / 64);
+
+    ///< an item leaves the bin right before the first entry that is not earlier than its exit
+    vector<int> entries(nbItems);
+    for (int k = 0; k < nbItems; k++) {
+        _items.push_back(sorted[k]->_id);
+        entries[k] = sorted[k]->_entry;
+    }
+    vector<vector<int>> leaving(nbItems);
+    for (int j = 0; j < nbItems; j++) {
+        const int k = lower_bound(entries.begin() + j + 1, entries.end(), sorted[j]->_exit) - entries.begin();
+        if (k < nbItems)
+            leaving[k].push_back(j);
+    }
+
+    auto addEvent = [&](int k, int64_t delta, bool check){
+        _eventWords.push_back(k >> 6);
+        _eventBits.push_back(uint64_t(1) << (k & 63));
+        _eventDeltas.push_back(delta);
+        _eventChecks.push_back(check);
+    };
+    for (int k = 0; k < nbItems; k++) {
+        for (const auto & j : leaving[k])
+            addEvent(j, -sorted[j]->_size, false);
+        addEvent(k, sorted[k]->_size, true);
+    }
+}
+
+vector<uint64_t> FeasibilityKernel::getMask(const vector<int> & selection) const {
+    vector<uint64_t> mask(_nbWords, 0);
+    for (const auto & itemId : selection) {
+        const int k = lower_bound(_items.begin(), _items.end(), itemId) - _items.begin();
+        if (k < getNbItems() && _items[k] == itemId)
+            mask[k >> 6] |= uint64_t(1) << (k & 63);
+    }
+    return mask;
+}
+
+bool FeasibilityKernel::isFeasible(const uint64_t * mask) const {
+    int64_t load = 0;
+    for (size_t e = 0; e < _eventDeltas.size(); e++) {
+        if (!(mask[_eventWords[e]] & _eventBits[e])) continue;
+        load += _eventDeltas[e];
+        if (_eventChecks[e] && load > _capacity) return false;
+    }
+    return true;
+}
+
+int FeasibilityKernel::checkBatchScalar(const uint64_t * masks, int nbMasks, char * feasible) const {
+    int nbFeasible = 0;
+    for (int m = 0; m < nbMasks; m++) {
+        feasible[m] = isFeasible(masks + (size_t)m * _nbWords);
+        nbFeasible += feasible[m];
+    }
+    return nbFeasible;
+}
+
+int FeasibilityKernel::checkBatch(const uint64_t * masks, int nbMasks, char * feasible) const {
+    TBP_PROFILE_SCOPE("feasibility.batch");
+    TBP_PROFILE_COUNT("feasibility.masks", nbMasks);
+#ifdef TBP_FEASIBILITY_AVX2
+    if (hasSimd())
+        return checkBatchSimd(masks, nbMasks, feasible);
+#endif
+    return checkBatchScalar(masks, nbMasks, feasible);
+}
+
+#ifdef TBP_FEASIBILITY_AVX2
+
+bool FeasibilityKernel::hasSimd(){
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+/**
+ * Four subsets per iteration, one per 64-bit lane: the bit of the item of every event is turned into
+ * an all-ones lane, which selects the delta added to the load of that lane.
+ * The four subsets are left as soon as every one of them is over the capacity
+ */
+__attribute__((target("avx2")))
+int FeasibilityKernel::checkBatchSimd(const uint64_t * masks, int nbMasks, char * feasible) const {
+    const int nbEvents = _eventDeltas.size();
+    const __m256i capacity = _mm256_set1_epi64x(_capacity);
+    vector<uint64_t> transposed(4 * _nbWords);   ///< word w of the four subsets side by side, for wide cliques
+    int nbFeasible = 0;
+    int m = 0;
+    for (; m + 4 <= nbMasks; m += 4) {
+        const uint64_t * block = masks + (size_t)m * _nbWords;
+        if (_nbWords > 1) {
+            for (int l = 0; l < 4; l++)
+                for (int w = 0; w < _nbWords; w++)
+                    transposed[4 * w + l] = block[l * _nbWords + w];
+            block = transposed.data();
+        }
+        __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+        __m256i load = _mm256_setzero_si256();
+        __m256i over = _mm256_setzero_si256();
+        for (int e = 0; e < nbEvents; e++) {
+            if (_nbWords > 1)
+                words = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 4 * _eventWords[e]));
+            const __m256i bit = _mm256_set1_epi64x(_eventBits[e]);
+            const __m256i selected = _mm256_cmpeq_epi64(_mm256_and_si256(words, bit), bit);
+            load = _mm256_add_epi64(load, _mm256_and_si256(selected, _mm256_set1_epi64x(_eventDeltas[e])));
+            if (_eventChecks[e]) {
+                over = _mm256_or_si256(over, _mm256_cmpgt_epi64(load, capacity));
+                if (_mm256_movemask_pd(_mm256_castsi256_pd(over)) == 0xF) break;
+            }
+        }
+        const int overLanes = _mm256_movemask_pd(_mm256_castsi256_pd(over));
+        for (int l = 0; l < 4; l++) {
+            feasible[m + l] = !((overLanes >> l) & 1);
+            nbFeasible += feasible[m + l];
+        }
+    }
+    return nbFeasible + checkBatchScalar(masks + (size_t)m * _nbWords, nbMasks - m, feasible + m);
+}
+
+#else
+
+bool FeasibilityKernel::hasSimd(){
+    return false;
+}
+
+int FeasibilityKernel::checkBatchSimd(const uint64_t * masks, int nbMasks, char * feasible) const {
+    return checkBatchScalar(masks, nbMasks, feasible);
+}
+
+#endif
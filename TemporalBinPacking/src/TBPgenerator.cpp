@@ -0,0 +1,88 @@
+//
+// Created by lhirwashema on 2022-07-04.
+//
+
+#include "../include/TBPgenerator.hpp"
+#include <cmath>
+#include <random>
+
+using namespace std;
+
+/**
+ * Draws an integer uniformly in [lo, hi]
+ */
+static int drawInt(mt19937 & rng, int lo, int hi){
+    if (hi <= lo) return lo;
+    return lo + rng() % (unsigned int)(hi - lo + 1);
+}
+
+/**
+ * Draws an integer in [lo, hi] following a distribution
+ */
+static int drawInt(mt19937 & rng, Distribution distribution, int lo, int hi){
+    if (hi <= lo) return lo;
+    double value;
+    switch (distribution) {
+    case NORMAL:
+        value = normal_distribution<double>((lo + hi) / 2.0, (hi - lo) / 6.0)(rng);
+        break;
+    case EXPONENTIAL:
+        value = lo + exponential_distribution<double>(4.0 / (hi - lo))(rng);
+        break;
+    case BIMODAL: {
+        const int quarter = (hi - lo) / 4;
+        if (drawInt(rng, 0, 1) == 0)
+            return drawInt(rng, lo, lo + quarter);
+        return drawInt(rng, hi - quarter, hi);
+    }
+    default:
+        return drawInt(rng, lo, hi);
+    }
+    return max(lo, min(hi, (int)lround(value)));
+}
+
+static const char * DISTRIBUTION_NAMES[] = {"uniform", "normal", "exponential", "bimodal"};
+
+bool parseDistribution(const string & name, Distribution & distribution){
+    for (int d = UNIFORM; d <= BIMODAL; d++) {
+        if (name == DISTRIBUTION_NAMES[d]) {
+            distribution = Distribution(d);
+            return true;
+        }
+    }
+    return false;
+}
+
+string getDistributionName(Distribution distribution){
+    return DISTRIBUTION_NAMES[distribution];
+}
+
+int GeneratorParams::getHorizon() const {
+    if (_overlap <= 0)
+        return _horizon;
+    ///< items present at a time = number of items * average length / horizon
+    double meanLength = (_minLength + _maxLength) / 2.0;
+    if (_lengthDistribution == EXPONENTIAL)
+        meanLength = _minLength + (_maxLength - _minLength) / 4.0;
+    return max(1, (int)ceil(_nbItems * meanLength / _overlap));
+}
+
+vector<Item> generateItems(const GeneratorParams & params, unsigned int seed){
+    mt19937 rng(seed);
+    const int horizon = params.getHorizon();
+    vector<Item> items;
+    for (int i = 0; i < params._nbItems; i++) {
+        int size = drawInt(rng, params._sizeDistribution, params._minSize, params._maxSize);
+        int entry = drawInt(rng, 0, horizon - 1);
+        int exit = entry + drawInt(rng, params._lengthDistribution, params._minLength, params._maxLength);
+        items.push_back(Item(i, size, entry, exit));
+    }
+    return items;
+}
+
+void writeInstance(std::ostream & out, int capacity, const vector<Item> & items){
+    out << items.size() << "\t" << capacity << "\t" << 0 << "\t" << 0 << "\n";
+    for (const auto & item : items) {
+        out << item._id << "\t" << item._entry << "\t" << item._exit << "\t" << item._size << "\n";
+    }
+}
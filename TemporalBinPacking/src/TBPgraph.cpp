@@ -0,0 +1,215 @@
+//
+// Created by lhirwashema on 2022-07-08.
+//
+
+#include "../include/TBPgraph.hpp"
+#include <algorithm>
+
+using namespace std;
+
+LayeredGraph::LayeredGraph(){
+    _owned[COLUMN_OFFSETS].assign(1, 0);
+    _owned[VERTEX_ITEM_OFFSETS].assign(1, 0);
+    _owned[ARC_OFFSETS].assign(1, 0);
+    _owned[ARC_ITEM_OFFSETS].assign(1, 0);
+    bindOwned();
+}
+
+LayeredGraph::LayeredGraph(const LayeredGraph & graph) : _mapping(graph._mapping), _vertexColumns(graph._vertexColumns) {
+    if (_mapping) {   ///< copies share the mapped arrays
+        for (int k = 0; k < NB_GRAPH_ARRAYS; k++)
+            *getSpans()[k] = *graph.getSpans()[k];
+    } else {
+        for (int k = 0; k < NB_GRAPH_ARRAYS; k++)
+            _owned[k] = graph._owned[k];
+        bindOwned();
+    }
+}
+
+LayeredGraph::LayeredGraph(LayeredGraph && graph) : LayeredGraph() {
+    swap(graph);
+}
+
+LayeredGraph & LayeredGraph::operator=(LayeredGraph graph){
+    swap(graph);
+    return *this;
+}
+
+/**
+ * Swapping vectors keeps their buffers, so the spans stay valid once swapped as well
+ */
+void LayeredGraph::swap(LayeredGraph & graph){
+    for (int k = 0; k < NB_GRAPH_ARRAYS; k++) {
+        _owned[k].swap(graph._owned[k]);
+        std::swap(*getSpans()[k], *graph.getSpans()[k]);
+    }
+    _mapping.swap(graph._mapping);
+    _vertexColumns.swap(graph._vertexColumns);
+}
+
+array<IntSpan *, NB_GRAPH_ARRAYS> LayeredGraph::getSpans(){
+    return {{&_columnOffsets, &_vertexItemOffsets, &_vertexItems, &_arcOffsets,
+             &_arcSuccessors, &_arcItemOffsets, &_arcItems}};
+}
+
+array<const IntSpan *, NB_GRAPH_ARRAYS> LayeredGraph::getSpans() const {
+    return {{&_columnOffsets, &_vertexItemOffsets, &_vertexItems, &_arcOffsets,
+             &_arcSuccessors, &_arcItemOffsets, &_arcItems}};
+}
+
+void LayeredGraph::bindOwned(){
+    for (int k = 0; k < NB_GRAPH_ARRAYS; k++)
+        *getSpans()[k] = IntSpan(_owned[k].data(), _owned[k].size());
+}
+
+void LayeredGraph::mapArrays(const shared_ptr<const void> & mapping, const vector<IntSpan> & arrays){
+    for (int k = 0; k < NB_GRAPH_ARRAYS; k++) {
+        vector<int>().swap(_owned[k]);
+        *getSpans()[k] = arrays[k];
+    }
+    _mapping = mapping;
+    indexVertices();
+}
+
+void LayeredGraph::indexVertices(){
+    _vertexColumns.resize(getNbVertices());
+    for (int c = 0; c < getNbColumns(); c++)
+        fill(_vertexColumns.begin() + _columnOffsets[c], _vertexColumns.begin() + _columnOffsets[c + 1], c);
+}
+
+void LayeredGraph::makeOwned(){
+    if (_mapping) {   ///< the mapped arrays are read-only
+        for (int k = 0; k < NB_GRAPH_ARRAYS; k++)
+            _owned[k].assign(getSpans()[k]->begin(), getSpans()[k]->end());
+        bindOwned();      ///< before the mapping goes, the spans would point into it
+        _mapping.reset();
+    }
+}
+
+void LayeredGraph::appendColumn(const GraphColumn & column){
+    makeOwned();
+    vector<int> & columnOffsets = _owned[COLUMN_OFFSETS];
+    vector<int> & vertexItemOffsets = _owned[VERTEX_ITEM_OFFSETS];
+    vector<int> & vertexItems = _owned[VERTEX_ITEMS];
+    vector<int> & arcOffsets = _owned[ARC_OFFSETS];
+    vector<int> & arcSuccessors = _owned[ARC_SUCCESSORS];
+    vector<int> & arcItemOffsets = _owned[ARC_ITEM_OFFSETS];
+    vector<int> & arcItems = _owned[ARC_ITEMS];
+
+    const int firstId = vertexItemOffsets.size() - 1;
+    const int nextFirstId = firstId + column.getNbVertices();   ///< ID of the first vertex of the next column
+
+    for (int r = 0; r < column.getNbVertices(); r++) {
+        vertexItems.insert(vertexItems.end(),
+                           column._items.begin() + column._itemOffsets[r],
+                           column._items.begin() + column._itemOffsets[r + 1]);
+        vertexItemOffsets.push_back(vertexItems.size());
+
+        for (int a = column._arcOffsets[r]; a < column._arcOffsets[r + 1]; a++) {
+            arcSuccessors.push_back(nextFirstId + column._arcTargets[a]);
+            arcItems.insert(arcItems.end(),
+                            column._arcItems.begin() + column._arcItemOffsets[a],
+                            column._arcItems.begin() + column._arcItemOffsets[a + 1]);
+            arcItemOffsets.push_back(arcItems.size());
+        }
+        arcOffsets.push_back(arcSuccessors.size());
+    }
+    _vertexColumns.insert(_vertexColumns.end(), column.getNbVertices(), columnOffsets.size() - 1);
+    columnOffsets.push_back(nextFirstId);
+    bindOwned();
+}
+
+void LayeredGraph::assemble(const vector<GraphColumn> & columns){
+    assemble(columns.data(), columns.size());
+}
+
+void LayeredGraph::assemble(const GraphColumn * columns, int nbColumns){
+    ///< the arrays are allocated once for all columns, growing them column by column would copy them again and again
+    size_t sizes[NB_GRAPH_ARRAYS];
+    for (int k = 0; k < NB_GRAPH_ARRAYS; k++)
+        sizes[k] = getArray(GraphArray(k)).size();
+    for (int c = 0; c < nbColumns; c++) {
+        const GraphColumn & column = columns[c];
+        sizes[COLUMN_OFFSETS]++;
+        sizes[VERTEX_ITEM_OFFSETS] += column.getNbVertices();
+        sizes[VERTEX_ITEMS] += column._items.size();
+        sizes[ARC_OFFSETS] += column.getNbVertices();
+        sizes[ARC_SUCCESSORS] += column.getNbArcs();
+        sizes[ARC_ITEM_OFFSETS] += column.getNbArcs();
+        sizes[ARC_ITEMS] += column._arcItems.size();
+    }
+    if (!_mapping) {
+        for (int k = 0; k < NB_GRAPH_ARRAYS; k++)
+            _owned[k].reserve(sizes[k]);
+        _vertexColumns.reserve(sizes[VERTEX_ITEM_OFFSETS] - 1);
+    }
+
+    for (int c = 0; c < nbColumns; c++) {
+        appendColumn(columns[c]);
+    }
+}
+
+/**
+ * Replaces values[begin, end) by replacement[i] + shift and adds tailShift to the values that follow,
+ * moving them only once
+ */
+static void spliceArray(vector<int> & values, size_t begin, size_t end, const IntSpan & replacement, int shift, int tailShift){
+    const size_t oldSize = values.size();
+    const size_t newEnd = begin + replacement.size();
+    if (newEnd > end) {
+        values.resize(oldSize + newEnd - end);
+        move_backward(values.begin() + end, values.begin() + oldSize, values.end());
+    } else if (newEnd < end) {
+        move(values.begin() + end, values.end(), values.begin() + newEnd);
+        values.resize(oldSize - (end - newEnd));
+    }
+    for (size_t i = 0; i < replacement.size(); i++)
+        values[begin + i] = replacement[i] + shift;
+    if (tailShift != 0)
+        for (size_t i = newEnd; i < values.size(); i++)
+            values[i] += tailShift;
+}
+
+void LayeredGraph::replaceColumns(int first, int oldLast, const GraphColumn * columns, int nbColumns){
+    makeOwned();
+    LayeredGraph part;
+    part.assemble(columns, nbColumns);
+
+    const int firstVertex = _columnOffsets[first];
+    const int lastVertex = _columnOffsets[oldLast];
+    const int firstArc = _arcOffsets[firstVertex];
+    const int lastArc = _arcOffsets[lastVertex];
+    const int firstVertexItem = _vertexItemOffsets[firstVertex];
+    const int lastVertexItem = _vertexItemOffsets[lastVertex];
+    const int firstArcItem = _arcItemOffsets[firstArc];
+    const int lastArcItem = _arcItemOffsets[lastArc];
+    const int vertexShift = part.getNbVertices() - (lastVertex - firstVertex);
+
+    ///< offsets arrays start with a 0 that belongs to the previous column, only the following entries are replaced
+    auto tail = [](const IntSpan & offsets){ return IntSpan(offsets.data() + 1, offsets.size() - 1); };
+    spliceArray(_owned[COLUMN_OFFSETS], first + 1, oldLast + 1, tail(part._columnOffsets), firstVertex, vertexShift);
+    spliceArray(_owned[VERTEX_ITEM_OFFSETS], firstVertex + 1, lastVertex + 1, tail(part._vertexItemOffsets), firstVertexItem,
+                (int)part._vertexItems.size() - (lastVertexItem - firstVertexItem));
+    spliceArray(_owned[VERTEX_ITEMS], firstVertexItem, lastVertexItem, part._vertexItems, 0, 0);
+    spliceArray(_owned[ARC_OFFSETS], firstVertex + 1, lastVertex + 1, tail(part._arcOffsets), firstArc,
+                part.getNbArcs() - (lastArc - firstArc));
+    ///< successors of the replaced columns count from the first of them, the following ones move with the vertices
+    spliceArray(_owned[ARC_SUCCESSORS], firstArc, lastArc, part._arcSuccessors, firstVertex, vertexShift);
+    spliceArray(_owned[ARC_ITEM_OFFSETS], firstArc + 1, lastArc + 1, tail(part._arcItemOffsets), firstArcItem,
+                (int)part._arcItems.size() - (lastArcItem - firstArcItem));
+    spliceArray(_owned[ARC_ITEMS], firstArcItem, lastArcItem, part._arcItems, 0, 0);
+    ///< the columns of the part count from 0, the following columns move by the difference in number of columns
+    spliceArray(_vertexColumns, firstVertex, lastVertex, IntSpan(part._vertexColumns.data(), part._vertexColumns.size()),
+                first, nbColumns - (oldLast - first));
+    bindOwned();
+}
+
+void LayeredGraph::renumberItems(int column, const vector<int> & itemMap){
+    makeOwned();
+    const int firstVertex = _columnOffsets[column];
+    const int lastVertex = _columnOffsets[column + 1];
+    for (int i = _vertexItemOffsets[firstVertex]; i < _vertexItemOffsets[lastVertex]; i++)
+        _owned[VERTEX_ITEMS][i] = itemMap[_owned[VERTEX_ITEMS][i]];
+    for (int i = _arcItemOffsets[_arcOffsets[firstVertex]]; i < _arcItemOffsets[_arcOffsets[lastVertex]]; i++)
+        _owned[ARC_ITEMS][i] = itemMap[_owned[ARC_ITEMS][i]];
+}
@@ -0,0 +1,124 @@
+//
+// Created by lhirwashema on 2022-08-02.
+//
+
+#include "../include/TBPimplicit.hpp"
+#include "../include/TBPprofile.hpp"
+
+using namespace std;
+
+ImplicitGraph::ImplicitGraph(const vector<Item> & items, int capacity, const CliqueSet & cliques, size_t cacheSize) :
+    _capacity(capacity), _cliques(cliques), _maxCacheSize(cacheSize), _nbGenerated(0), _nbCacheHits(0)
+{
+    init(items);
+}
+
+ImplicitGraph::ImplicitGraph(TemporalBPData & data, bool reduced, size_t cacheSize) :
+    _capacity(data.getCapacity()), _cliques(reduced ? CliqueSet(data.getReducedCliques()) : data.getMaxCliqueSet()),
+    _maxCacheSize(cacheSize), _nbGenerated(0), _nbCacheHits(0)
+{
+    init(data._items);
+}
+
+void ImplicitGraph::init(const vector<Item> & items){
+    TBP_PROFILE_SCOPE("implicitGraph.init");
+    _kernels.reserve(getNbCliques());
+    for (int c = 0; c < getNbCliques(); c++)
+        _kernels.push_back(FeasibilityKernel(items, _capacity, _cliques.getClique(c)));
+}
+
+vector<int> ImplicitGraph::getItems(const ImplicitVertex & vertex) const {
+    vector<int> items;
+    if (vertex._clique < 0 || isSink(vertex))
+        return items;
+    const vector<int> & cliqueItems = _kernels[vertex._clique].getItems();
+    for (int k = 0; k < (int)cliqueItems.size(); k++)
+        if (vertex._mask[k >> 6] >> (k & 63) & 1)
+            items.push_back(cliqueItems[k]);
+    return items;
+}
+
+shared_ptr<const SuccessorList> ImplicitGraph::getSuccessors(const ImplicitVertex & vertex){
+    auto found = _cache.find(vertex);
+    if (found != _cache.end()) {
+        _nbCacheHits++;
+        _recent.splice(_recent.begin(), _recent, found->second);
+        return found->second->second;
+    }
+    _nbGenerated++;
+    shared_ptr<const SuccessorList> successors = generate(vertex);
+    if (_maxCacheSize > 0) {
+        _recent.push_front(CacheEntry(vertex, successors));
+        _cache[vertex] = _recent.begin();
+        while (_cache.size() > _maxCacheSize) {   ///< the least recently used list goes first
+            _cache.erase(_recent.back().first);
+            _recent.pop_back();
+        }
+    }
+    return successors;
+}
+
+/**
+ * Adds the new items from position k on to mask in every way that still fits, each completed mask being a successor.
+ * The item at newPositions[k] is first left out, then added if the mask stays feasible
+ */
+static void extendMask(const FeasibilityKernel & kernel, const vector<int> & newPositions, int k,
+                       vector<uint64_t> & mask, vector<int> & added, SuccessorList & successors){
+    if (k == (int)newPositions.size()) {
+        successors._masks.insert(successors._masks.end(), mask.begin(), mask.end());
+        successors._newItems.insert(successors._newItems.end(), added.begin(), added.end());
+        successors._newItemOffsets.push_back(successors._newItems.size());
+        return;
+    }
+    extendMask(kernel, newPositions, k + 1, mask, added, successors);
+    const int & position = newPositions[k];
+    const uint64_t bit = uint64_t(1) << (position & 63);
+    mask[position >> 6] |= bit;
+    if (kernel.isFeasible(mask.data())) {   ///< feasibility is hereditary: no superset of an infeasible mask fits
+        added.push_back(kernel.getItems()[position]);
+        extendMask(kernel, newPositions, k + 1, mask, added, successors);
+        added.pop_back();
+    }
+    mask[position >> 6] &= ~bit;
+}
+
+shared_ptr<const SuccessorList> ImplicitGraph::generate(const ImplicitVertex & vertex) const {
+    TBP_PROFILE_SCOPE("implicitGraph.generate");
+    shared_ptr<SuccessorList> successors = make_shared<SuccessorList>();
+    const int next = vertex._clique + 1;
+    successors->_clique = next;
+    if (isSink(vertex))
+        return successors;
+    if (next == getNbCliques()) {   ///< any vertex of the last clique connects to the sink
+        successors->_masks.push_back(0);
+        successors->_newItemOffsets.push_back(0);
+        return successors;
+    }
+
+    const FeasibilityKernel & kernel = _kernels[next];
+    const vector<int> & nextItems = kernel.getItems();
+    successors->_nbWords = kernel.getNbWords();
+    vector<uint64_t> mask(kernel.getNbWords(), 0);   ///< items of the vertex kept in the next clique
+    vector<int> newPositions;                        ///< positions of the items of the next clique not in this one
+    if (vertex._clique < 0) {
+        for (int j = 0; j < (int)nextItems.size(); j++)
+            newPositions.push_back(j);
+    } else {
+        const vector<int> & items = _kernels[vertex._clique].getItems();
+        int i = 0;
+        for (int j = 0; j < (int)nextItems.size(); j++) {
+            while (i < (int)items.size() && items[i] < nextItems[j])
+                i++;
+            if (i < (int)items.size() && items[i] == nextItems[j]) {   ///< shared item, kept as it is in the vertex
+                if (vertex._mask[i >> 6] >> (i & 63) & 1)
+                    mask[j >> 6] |= uint64_t(1) << (j & 63);
+            } else {
+                newPositions.push_back(j);
+            }
+        }
+    }
+    vector<int> added;
+    extendMask(kernel, newPositions, 0, mask, added, *successors);
+    TBP_PROFILE_COUNT("implicitGraph.successors", successors->size());
+    return successors;
+}
@@ -0,0 +1,150 @@
+//
+// Created by lhirwashema on 2022-07-13.
+//
+
+#include "../include/TBPlinker.hpp"
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * Projections of the combinations of a clique onto the shared items, stored flat with _nbWords words per key
+ */
+class ProjectionKeys {
+public:
+    int _nbWords;
+    vector<uint64_t> _keys;
+
+    ProjectionKeys(const FeasibleCombos & combos, const vector<int> & sharedPositions) :
+        _nbWords(max<int>(1, (sharedPositions.size() + 63) / 64)),
+        _keys(combos.size() * _nbWords, 0)
+    {
+        for (int c = 0; c < combos.size(); c++) {
+            uint64_t * key = &_keys[c * _nbWords];
+            for (int k = 0; k < (int)sharedPositions.size(); k++) {
+                if (combos.contains(c, sharedPositions[k]))
+                    key[k >> 6] |= uint64_t(1) << (k & 63);
+            }
+        }
+    }
+
+    const uint64_t * getKey(int c) const { return &_keys[c * _nbWords]; }
+
+    bool less(const uint64_t * a, const uint64_t * b) const {
+        return lexicographical_compare(a, a + _nbWords, b, b + _nbWords);
+    }
+};
+
+/**
+ * Positions of the items shared by two cliques in each of them, items of a clique being sorted by ID
+ */
+static void findSharedPositions(const FeasibleCombos & current, const FeasibleCombos & next,
+                                vector<int> & sharedCurrent, vector<int> & sharedNext){
+    sharedCurrent.reserve(min(current.getNbItems(), next.getNbItems()));
+    sharedNext.reserve(min(current.getNbItems(), next.getNbItems()));
+    for (int i = 0, j = 0; i < current.getNbItems() && j < next.getNbItems(); ) {
+        if (current._items[i] < next._items[j]) i++;
+        else if (current._items[i] > next._items[j]) j++;
+        else {
+            sharedCurrent.push_back(i);
+            sharedNext.push_back(j);
+            i++;
+            j++;
+        }
+    }
+}
+
+long countLinks(const FeasibleCombos & current, const FeasibleCombos & next){
+    vector<int> sharedCurrent;
+    vector<int> sharedNext;
+    findSharedPositions(current, next, sharedCurrent, sharedNext);
+    ProjectionKeys currentKeys(current, sharedCurrent);
+    ProjectionKeys nextKeys(next, sharedNext);
+
+    vector<int> order(next.size());
+    for (int v = 0; v < next.size(); v++)
+        order[v] = v;
+    sort(order.begin(), order.end(), [&](int v, int w){
+        return nextKeys.less(nextKeys.getKey(v), nextKeys.getKey(w));
+    });
+
+    long nbLinks = 0;
+    for (int u = 0; u < current.size(); u++) {
+        const uint64_t * key = currentKeys.getKey(u);
+        auto range = equal_range(order.begin(), order.end(), -1, [&](int v, int w){
+            return nextKeys.less(v < 0 ? key : nextKeys.getKey(v), w < 0 ? key : nextKeys.getKey(w));
+        });
+        nbLinks += range.second - range.first;
+    }
+    return nbLinks;
+}
+
+void linkIndexed(const FeasibleCombos & current, const FeasibleCombos & next, GraphColumn & column){
+    vector<int> sharedCurrent;
+    vector<int> sharedNext;
+    findSharedPositions(current, next, sharedCurrent, sharedNext);
+    vector<char> isSharedNext(next.getNbItems(), 0);
+    for (const auto & k : sharedNext)
+        isSharedNext[k] = 1;
+
+    ProjectionKeys currentKeys(current, sharedCurrent);
+    ProjectionKeys nextKeys(next, sharedNext);
+
+    ///< vertices of the next column sorted by key, then by row
+    vector<int> order(next.size());
+    for (int v = 0; v < next.size(); v++)
+        order[v] = v;
+    sort(order.begin(), order.end(), [&](int v, int w){
+        const uint64_t * vKey = nextKeys.getKey(v);
+        const uint64_t * wKey = nextKeys.getKey(w);
+        return nextKeys.less(vKey, wKey) || (!nextKeys.less(wKey, vKey) && v < w);
+    });
+
+    ///< new items brought by each vertex of the next column
+    vector<int> newItemOffsets(1, 0);
+    vector<int> newItems;
+    size_t nbNewItems = 0;
+    for (int v = 0; v < next.size(); v++)
+        nbNewItems += next.getNbItems(v);
+    newItemOffsets.reserve(next.size() + 1);
+    newItems.reserve(nbNewItems);
+    for (int v = 0; v < next.size(); v++) {
+        for (int k = 0; k < next.getNbItems(); k++)
+            if (!isSharedNext[k] && next.contains(v, k))
+                newItems.push_back(next._items[k]);
+        newItemOffsets.push_back(newItems.size());
+    }
+
+    ///< successors of every vertex found first, so that the arrays of the column are sized once
+    vector<int> firstSuccessor(current.size());
+    vector<int> lastSuccessor(current.size());
+    size_t nbArcs = 0;
+    size_t nbArcItems = 0;
+    for (int u = 0; u < current.size(); u++) {
+        const uint64_t * key = currentKeys.getKey(u);
+        auto first = lower_bound(order.begin(), order.end(), key, [&](int v, const uint64_t * k){
+            return nextKeys.less(nextKeys.getKey(v), k);
+        });
+        auto last = first;
+        for (; last != order.end() && !nextKeys.less(key, nextKeys.getKey(*last)); last++)
+            nbArcItems += newItemOffsets[*last + 1] - newItemOffsets[*last];
+        firstSuccessor[u] = first - order.begin();
+        lastSuccessor[u] = last - order.begin();
+        nbArcs += last - first;
+    }
+    column._arcOffsets.reserve(column._arcOffsets.size() + current.size());
+    column._arcTargets.reserve(column._arcTargets.size() + nbArcs);
+    column._arcItemOffsets.reserve(column._arcItemOffsets.size() + nbArcs);
+    column._arcItems.reserve(column._arcItems.size() + nbArcItems);
+
+    for (int u = 0; u < current.size(); u++) {
+        for (int s = firstSuccessor[u]; s < lastSuccessor[u]; s++) {
+            const int & v = order[s];
+            column._arcItems.insert(column._arcItems.end(),
+                                    newItems.begin() + newItemOffsets[v],
+                                    newItems.begin() + newItemOffsets[v + 1]);
+            column.closeArc(v);
+        }
+        column._arcOffsets.push_back(column._arcTargets.size());
+    }
+}
@@ -1,39 +1,37 @@
+#include "../include/TBPbatch.hpp"
 #include "../include/TBPdata.hpp"
+#include "../include/TBPexport.hpp"
+#include "../include/TBPparallel.hpp"
+#include "../include/TBPparser.hpp"
+#include <sys/stat.h>
+#include <cstdlib>
 #include <string>
 #include <vector>
 #include <iomanip>
 
-string list_items(vector<int> items){
-    string sItems = "(";
-    for (int i=0; i<items.size(); i++) {
-        sItems += to_string(items[i]);
-        if (i<items.size()-1) {
-            sItems += ",";
-        }
+/**
+ * Items of a vertex as (i,j,...), written straight to the stream
+ */
+void list_items(ostream & out, const int * begin, const int * end){
+    out << '(';
+    for (const int * i = begin; i != end; ++i) {
+        if (i != begin) out << ',';
+        out << *i;
     }
-    sItems += ")";
-    return sItems;
+    out << ')';
 }
 
-string list_arcs(vector<Arc> arcs){
-    string sItems = "{";
-    for (int i=0; i<arcs.size(); i++) {
-        sItems += to_string(arcs[i]._successorId);
-        if (arcs[i]._newItems.empty())
-        {
-            sItems += "-";
-        }else
-        {
-            sItems += "+";
-        }
-        
-        
-        if (i<arcs.size()-1) {
-            sItems += ",";
-        }
+/**
+ * Arcs of a vertex as {successor+,successor-,...}, + when the arc takes new items
+ */
+void list_arcs(ostream & out, const VertexView & u){
+    out << '{';
+    for (int i=0; i<u.getNbArcs(); i++) {
+        ArcView arc = u.getArc(i);
+        if (i > 0) out << ',';
+        out << arc.getSuccessorId() << (arc.getNbNewItems() == 0 ? '-' : '+');
     }
-    sItems += "}";
-    return sItems;
+    out << '}';
 }
 /*
 void successive_display(TBPProblem * problem, Vertex* u, int column){
@@ -64,35 +62,24 @@ void display_graph(TBPProblem * problem){
 }
 */
 
-int main(int argc, char * argv[]){
-    //TemporalBPData data = TemporalBPData();
-    string fileName = "../data/I_1.txt";
+/**
+ * Prints the graph and the reduced cliques of an instance, as the executable used to do for its single instance
+ */
+void display_instance(TemporalBPData & data, const string & methodName){
     cout << "<testCSP> Reading the file " << endl;
-    ifstream dataFile(fileName);
-
-    TemporalBPData data;
-    string methodName = "Normal";
-
-    cout << "<testTBP> Creating " << methodName << " Graph" << endl;
-
-    if (methodName == "reduced")
-    {
-        data = TemporalBPData(dataFile, true);
-    }
-    else
-    {
-        data = TemporalBPData(dataFile, false);
-    }
-    
-    dataFile.close(); 
+    cout << "<testTBP> Creating " << (methodName == "normal" ? "Normal" : methodName) << " Graph" << endl;
 
     for(int c=0 ; c<data.getNbColumns() ; ++c){
-        for (int v = 0; v < data._graph[c].size(); v++)
+        for (int v = 0; v < data._graph.getColumnSize(c); v++)
         {
-            Vertex * u = & data._graph[c][v];
-            cout << "Vertex " << u->_id << " : \tItems = " << list_items(u->_items) << ",\t Arcs = " << list_arcs(u->_arcs) << endl;
+            VertexView u = data._graph.getVertex(c, v);
+            cout << "Vertex " << u.getId() << " : \tItems = ";
+            list_items(cout, u.itemsBegin(), u.itemsEnd());
+            cout << ",\t Arcs = ";
+            list_arcs(cout, u);
+            cout << '\n';
         }
-        cout << endl;
+        cout << '\n';
     }
 
     for (auto &&clique : data.getReducedCliques())
@@ -102,8 +89,157 @@ int main(int argc, char * argv[]){
         {
             cout << i << ", ";
         }
-        cout << ")," << endl;
+        cout << "),\n";
+    }
+    cout.flush();
+}
+
+void usage(){
+    cerr << "Usage: TBP [options] instance|folder ...\n"
+            "  --list file               instances listed in a manifest, one path per line\n"
+            "  --method m                graph built for every instance: normal, reduced, or events for one layer per entry\n"
+            "                            or exit of an item (normal)\n"
+            "  --workers n               instances solved concurrently (hardware threads)\n"
+            "  --build-workers n         threads building the graph of one instance (1)\n"
+            "  --memory-mb m             memory of the instances solved together, estimated from their graphs\n"
+            "  --graph-budget-mb m       largest estimated graph of an instance, replaced by the reduced then the aggregated one\n"
+            "                            beyond, refused if none fits\n"
+            "  --cache folder            reuses the graphs from one run to the next\n"
+            "  --prune 0|1               dominance pruning of the vertices (0)\n"
+            "  --bounds 0|1              skips the graph of the instances whose bounds meet (1)\n"
+            "  --decompose 0|1           solves apart the parts of an instance separated by idle dates (1)\n"
+            "  --aggregate 0|1           tries first the graph of the identical items grouped together, normal method only (0)\n"
+            "  --format csv|json         one result line per instance (csv)\n"
+            "  --export folder           writes the graph of the instances built whole (all with --bounds 0 --decompose 0)\n"
+            "  --export-format f         dimacs for DIMACS min-cost flow (.min), binary for an edge list with the items\n"
+            "                            of the arcs (.tbpe) (dimacs)\n"
+            "  --verbose                 prints the graph and cliques of the instances built whole (all with --bounds 0 --decompose 0)" << endl;
+}
+
+int main(int argc, char * argv[]){
+    BatchOptions options;
+    options._nbWorkers = getHardwareNbWorkers();
+    string methodName = "normal";
+    bool json = false;
+    bool verbose = false;
+    string exportFolder;
+    ExportFormat exportFormat = EXPORT_DIMACS;
+    vector<string> fileNames;
+
+    for (int a = 1; a < argc; a++) {
+        const string option = argv[a];
+        if (option == "--verbose") {
+            verbose = true;
+            continue;
+        }
+        if (option.compare(0, 2, "--") != 0) {
+            ///< a folder gives its .txt files, anything else is an instance
+            struct stat status;
+            vector<string> listed;
+            string error;
+            if (stat(option.c_str(), &status) == 0 && S_ISDIR(status.st_mode)) {
+                if (!listInstances(option, listed, error)) {
+                    cerr << "<testTBP> " << error << endl;
+                    return 1;
+                }
+                fileNames.insert(fileNames.end(), listed.begin(), listed.end());
+            } else
+                fileNames.push_back(option);
+            continue;
+        }
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const string value = argv[++a];
+        bool ok = true;
+        if (option == "--list") {
+            vector<string> listed;
+            string error;
+            if (!listInstances(value, listed, error)) {
+                cerr << "<testTBP> " << error << endl;
+                return 1;
+            }
+            fileNames.insert(fileNames.end(), listed.begin(), listed.end());
+        }
+        else if (option == "--method") {
+            methodName = value;
+            ok = methodName == "normal" || methodName == "reduced" || methodName == "events";
+        }
+        else if (option == "--workers") ok = (options._nbWorkers = atoi(value.c_str())) > 0;
+        else if (option == "--build-workers") ok = (options._buildOptions._nbWorkers = atoi(value.c_str())) > 0;
+        else if (option == "--memory-mb") options._memoryBudgetKb = atol(value.c_str()) * 1024;
+        else if (option == "--graph-budget-mb") options._buildOptions._graphBudgetKb = atol(value.c_str()) * 1024;
+        else if (option == "--cache") options._buildOptions._cacheFolder = value;
+        else if (option == "--prune") options._buildOptions._dominancePruning = (value == "1");
+        else if (option == "--bounds") options._useBounds = (value == "1");
+        else if (option == "--decompose") options._decompose = (value == "1");
+        else if (option == "--aggregate") options._aggregate = (value == "1");
+        else if (option == "--export") exportFolder = value;
+        else if (option == "--export-format") {
+            exportFormat = value == "binary" ? EXPORT_BINARY : EXPORT_DIMACS;
+            ok = value == "binary" || value == "dimacs";
+        }
+        else if (option == "--format") {
+            json = (value == "json");
+            ok = json || value == "csv";
+        }
+        else ok = false;
+        if (!ok) {
+            cerr << "<testTBP> Invalid option " << option << " " << value << endl;
+            usage();
+            return 1;
+        }
+    }
+    if (fileNames.empty()) {
+        usage();
+        return 1;
     }
-    
+    options._reduced = (methodName == "reduced");
+    options._events = (methodName == "events");
+
+    vector<ColumnStats> columnStats;
+    if (!json)
+        cout << InstanceResult::getCsvHeader() << endl;
+    const int nbFailures = runBatch(fileNames, options, [&](const InstanceResult & result, TemporalBPData * data){
+        if (!result.isValid())
+            cerr << result._fileName << ": " << result._error << endl;
+        if (verbose && data != nullptr)
+            display_instance(*data, methodName);
+        if (!exportFolder.empty() && data != nullptr && data->_graph.getNbVertices() > 0) {
+            const size_t slash = result._fileName.find_last_of('/');
+            string name = result._fileName.substr(slash == string::npos ? 0 : slash + 1);
+            const size_t dot = name.find_last_of('.');
+            if (dot != string::npos) name.resize(dot);
+            string error;
+            if (!exportGraph(data->_graph, exportFolder + "/" + name + getExportExtension(exportFormat), exportFormat, true, error))
+                cerr << "<testTBP> " << error << endl;
+        }
+        cout << (json ? result.toJson() : result.toCsv()) << endl;
+        if (data != nullptr && fileNames.size() == 1)
+            columnStats.swap(data->_columnStats);
+    });
 
-}
\ No newline at end of file
+#ifdef TBP_PROFILE
+    ///< timers of the stages, summed over the instances, and measures of every clique of a single instance,
+    ///< in JSON or in two CSV files
+    const char * profileFile = getenv("TBP_PROFILE_FILE");
+    if (profileFile != nullptr) {
+        const string profileName = profileFile;
+        ofstream out(profileName);
+        if (profileName.size() > 4 && profileName.substr(profileName.size() - 4) == ".csv") {
+            Profiler::getInstance().writeCsv(out);
+            ofstream cliquesOut(profileName.substr(0, profileName.size() - 4) + "_cliques.csv");
+            writeColumnStatsCsv(cliquesOut, columnStats);
+        } else {
+            out << "{\"stages\":";
+            Profiler::getInstance().writeJson(out);
+            out << ",\"cliques\":";
+            writeColumnStatsJson(out, columnStats);
+            out << "}" << endl;
+        }
+    }
+#endif
+
+    return nbFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+//
+// Created by lhirwashema on 2022-07-11.
+//
+
+#include "../include/TBPparallel.hpp"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Share of task indexes [_begin, _end) owned by a worker
+ */
+class WorkRange {
+public:
+    mutex _mutex;
+    int _begin;
+    int _end;
+
+    WorkRange() : _begin(0), _end(0) {}
+};
+
+int getHardwareNbWorkers(){
+    unsigned int nbThreads = thread::hardware_concurrency();
+    return nbThreads == 0 ? 1 : nbThreads;
+}
+
+/**
+ * Takes the next index of a range, -1 if it is empty
+ */
+static int popFront(WorkRange & range){
+    lock_guard<mutex> lock(range._mutex);
+    if (range._begin >= range._end) return -1;
+    return range._begin++;
+}
+
+/**
+ * Steals the upper half of the remaining indexes of another worker into the range of worker w,
+ * returns the first stolen index or -1 if every other range is empty
+ */
+static int steal(vector<WorkRange> & ranges, int w){
+    const int nbWorkers = ranges.size();
+    for (int k = 1; k < nbWorkers; k++) {
+        WorkRange & victim = ranges[(w + k) % nbWorkers];
+        int begin;
+        int end;
+        {
+            lock_guard<mutex> lock(victim._mutex);
+            int remaining = victim._end - victim._begin;
+            if (remaining <= 0) continue;
+            end = victim._end;
+            begin = end - (remaining + 1) / 2;
+            victim._end = begin;
+        }
+        lock_guard<mutex> lock(ranges[w]._mutex);
+        ranges[w]._begin = begin + 1;
+        ranges[w]._end = end;
+        return begin;
+    }
+    return -1;
+}
+
+void parallelFor(int nbTasks, int nbWorkers, const function<void(int)> & task){
+    nbWorkers = min(nbWorkers, nbTasks);
+    if (nbWorkers <= 1) {
+        for (int i = 0; i < nbTasks; i++)
+            task(i);
+        return;
+    }
+
+    vector<WorkRange> ranges(nbWorkers);
+    for (int w = 0; w < nbWorkers; w++) {
+        ranges[w]._begin = (long)nbTasks * w / nbWorkers;
+        ranges[w]._end = (long)nbTasks * (w + 1) / nbWorkers;
+    }
+
+    auto work = [&](int w){
+        while (true) {
+            int i = popFront(ranges[w]);
+            if (i == -1) i = steal(ranges, w);
+            if (i == -1) return;
+            task(i);
+        }
+    };
+
+    vector<thread> threads;
+    for (int w = 1; w < nbWorkers; w++)
+        threads.push_back(thread(work, w));
+    work(0);
+    for (auto & t : threads)
+        t.join();
+}
@@ -0,0 +1,219 @@
+//
+// Created by lhirwashema on 2022-07-19.
+//
+
+#include "../include/TBPparser.hpp"
+#include "../include/TBPparallel.hpp"
+#include "../include/TBPprofile.hpp"
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+using namespace std;
+
+/**
+ * Cursor over the buffer of an instance, lines being counted from 1
+ */
+class BufferReader {
+public:
+    const char * _p;
+    const char * _end;
+    int _line;
+
+    BufferReader(const char * begin, const char * end) : _p(begin), _end(end), _line(1) {}
+
+    void skipBlanks(){
+        while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\r')) _p++;
+    }
+
+    /**
+     * Moves to the first line that is not empty, returns false at the end of the buffer
+     */
+    bool skipEmptyLines(){
+        for (;;) {
+            skipBlanks();
+            if (_p == _end) return false;
+            if (*_p != '\n') return true;
+            _p++;
+            _line++;
+        }
+    }
+
+    /**
+     * Decodes the next integer of the current line
+     */
+    bool readInt(int & value){
+        skipBlanks();
+        bool negative = false;
+        if (_p < _end && (*_p == '-' || *_p == '+')) negative = (*_p++ == '-');
+        if (_p == _end || *_p < '0' || *_p > '9') return false;
+        long long v = 0;
+        while (_p < _end && *_p >= '0' && *_p <= '9') {
+            v = v * 10 + (*_p++ - '0');
+            if (v > INT_MAX) return false;
+        }
+        value = negative ? -v : v;
+        return true;
+    }
+
+    /**
+     * Checks that nothing but blanks remains on the current line and moves to the next one
+     */
+    bool endLine(){
+        skipBlanks();
+        if (_p == _end) return true;
+        if (*_p != '\n') return false;
+        _p++;
+        _line++;
+        return true;
+    }
+
+    string at() const { return "line " + to_string(_line) + ": "; }
+};
+
+bool parseInstanceBuffer(const char * begin, const char * end, int & capacity, vector<Item> & items, string & error){
+    BufferReader reader(begin, end);
+    items.clear();
+
+    int nbItems;
+    int unused;
+    if (!reader.skipEmptyLines()) {
+        error = "empty instance";
+        return false;
+    }
+    if (!reader.readInt(nbItems) || !reader.readInt(capacity)
+     || !reader.readInt(unused) || !reader.readInt(unused) || !reader.endLine()) {
+        error = reader.at() + "expected the header \"nbItems capacity 0 0\"";
+        return false;
+    }
+    if (nbItems < 0 || capacity <= 0) {
+        error = reader.at() + "invalid number of items or capacity";
+        return false;
+    }
+
+    items.reserve(nbItems);
+    int id;
+    int entry;
+    int exit;
+    int size;
+    for (int i = 0; i < nbItems; i++) {
+        if (!reader.skipEmptyLines()) {
+            error = "expected " + to_string(nbItems) + " items, found " + to_string(i);
+            return false;
+        }
+        if (!reader.readInt(id) || !reader.readInt(entry) || !reader.readInt(exit)
+         || !reader.readInt(size) || !reader.endLine()) {
+            error = reader.at() + "expected \"id entry exit size\"";
+            return false;
+        }
+        if (exit < entry || size < 0 || size > capacity) {
+            error = reader.at() + "invalid item " + to_string(id);
+            return false;
+        }
+        items.push_back(Item(id, size, entry, exit));
+    }
+    if (reader.skipEmptyLines()) {
+        error = reader.at() + "more lines than the " + to_string(nbItems) + " items of the header";
+        return false;
+    }
+    return true;
+}
+
+TBPInstance parseInstance(const string & fileName){
+    TBP_PROFILE_SCOPE("parseInstance");
+    TBPInstance instance;
+    instance._fileName = fileName;
+
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        instance._error = "cannot open the file: " + string(strerror(errno));
+        return instance;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+        instance._error = "not a regular file";
+        close(fd);
+        return instance;
+    }
+    const size_t length = status.st_size;
+    if (length == 0) {
+        instance._error = "empty instance";
+        close(fd);
+        return instance;
+    }
+    void * data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);   ///< the mapping stays valid once the descriptor is closed
+    if (data == MAP_FAILED) {
+        instance._error = "cannot map the file: " + string(strerror(errno));
+        return instance;
+    }
+    madvise(data, length, MADV_SEQUENTIAL);
+
+    const char * begin = static_cast<const char *>(data);
+    parseInstanceBuffer(begin, begin + length, instance._capacity, instance._items, instance._error);
+    munmap(data, length);
+    return instance;
+}
+
+static bool endsWith(const string & s, const string & suffix){
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool listInstances(const string & path, vector<string> & fileNames, string & error){
+    fileNames.clear();
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+
+    if (S_ISDIR(status.st_mode)) {
+        DIR * dir = opendir(path.c_str());
+        if (dir == nullptr) {
+            error = path + ": " + strerror(errno);
+            return false;
+        }
+        const string prefix = endsWith(path, "/") ? path : path + "/";
+        struct dirent * entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            const string name = entry->d_name;
+            struct stat fileStatus;
+            if (endsWith(name, ".txt") && stat((prefix + name).c_str(), &fileStatus) == 0 && S_ISREG(fileStatus.st_mode))
+                fileNames.push_back(prefix + name);
+        }
+        closedir(dir);
+        sort(fileNames.begin(), fileNames.end());
+        return true;
+    }
+
+    ///< manifest: paths are relative to its folder
+    ifstream in(path);
+    if (!in) {
+        error = path + ": cannot open the manifest";
+        return false;
+    }
+    const size_t slash = path.find_last_of('/');
+    const string folder = slash == string::npos ? "" : path.substr(0, slash + 1);
+    string line;
+    while (getline(in, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') continue;
+        fileNames.push_back(line[0] == '/' ? line : folder + line);
+    }
+    return true;
+}
+
+vector<TBPInstance> loadInstances(const vector<string> & fileNames, int nbWorkers){
+    vector<TBPInstance> instances(fileNames.size());
+    parallelFor(fileNames.size(), nbWorkers, [&](int i){
+        instances[i] = parseInstance(fileNames[i]);
+    });
+    return instances;
+}
@@ -0,0 +1,194 @@
+//
+// Created by lhirwashema on 2022-08-01.
+//
+
+#include "../include/TBPpricing.hpp"
+#include "../include/TBPprofile.hpp"
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+/**
+ * Partial path reaching a vertex: its weight, its last arc and the label it extends
+ */
+class PricingLabel {
+public:
+    double _weight;
+    int _arc;
+    int _parent;     ///< index of the label of the source of _arc, -1 at the start
+
+    PricingLabel(double weight, int arc, int parent) : _weight(weight), _arc(arc), _parent(parent) {}
+
+    bool operator<(const PricingLabel & label) const { return _weight > label._weight; }   ///< heaviest first
+};
+
+TBPPricer::TBPPricer(const LayeredGraph & graph, int nbItems) :
+    _binCost(1),
+    _graph(graph),
+    _duals(nbItems, 0),
+    _arcWeights(graph.getNbArcs(), 0),
+    _arcSources(graph.getNbArcs()),
+    _arcMasked(graph.getNbArcs(), 0),
+    _vertexMasked(graph.getNbVertices(), 0)
+{
+    for (int u = 0; u < graph.getNbVertices(); u++)
+        fill(_arcSources.begin() + graph._arcOffsets[u], _arcSources.begin() + graph._arcOffsets[u + 1], u);
+
+    _itemArcOffsets.assign(nbItems + 1, 0);
+    for (const auto & item : graph._arcItems)
+        _itemArcOffsets[item + 1]++;
+    for (int i = 0; i < nbItems; i++)
+        _itemArcOffsets[i + 1] += _itemArcOffsets[i];
+    _itemArcs.resize(_itemArcOffsets[nbItems]);
+    vector<int> next(_itemArcOffsets.begin(), _itemArcOffsets.end() - 1);
+    for (int a = 0; a < graph.getNbArcs(); a++)
+        for (int k = graph._arcItemOffsets[a]; k < graph._arcItemOffsets[a + 1]; k++)
+            _itemArcs[next[graph._arcItems[k]]++] = a;
+}
+
+void TBPPricer::setDuals(const vector<double> & duals){
+    TBP_PROFILE_SCOPE("pricing.setDuals");
+    _duals = duals;
+    const IntSpan & offsets = _graph._arcItemOffsets;
+    const IntSpan & items = _graph._arcItems;
+    for (int a = 0; a < _graph.getNbArcs(); a++) {
+        double weight = 0;
+        for (int k = offsets[a]; k < offsets[a + 1]; k++)
+            weight += _duals[items[k]];
+        _arcWeights[a] = weight;
+    }
+}
+
+void TBPPricer::setDual(int item, double dual){
+    const double delta = dual - _duals[item];
+    _duals[item] = dual;
+    for (const int * a = itemArcsBegin(item); a != itemArcsEnd(item); a++)
+        _arcWeights[*a] += delta;
+}
+
+void TBPPricer::clearMasks(){
+    fill(_arcMasked.begin(), _arcMasked.end(), 0);
+    fill(_vertexMasked.begin(), _vertexMasked.end(), 0);
+}
+
+void TBPPricer::makePath(vector<int> & arcs, double weight, PricingPath & path) const {
+    reverse(arcs.begin(), arcs.end());
+    path._weight = weight;
+    path._reducedCost = _binCost - weight;
+    path._arcs = arcs;
+    path._vertices.assign(1, arcs.empty() ? 0 : _arcSources[arcs.front()]);
+    path._items.clear();
+    for (const auto & a : arcs) {
+        path._vertices.push_back(_graph._arcSuccessors[a]);
+        path._items.insert(path._items.end(), _graph._arcItems.begin() + _graph._arcItemOffsets[a],
+                           _graph._arcItems.begin() + _graph._arcItemOffsets[a + 1]);
+    }
+}
+
+bool TBPPricer::findBestPath(PricingPath & path) const {
+    TBP_PROFILE_SCOPE("pricing.bestPath");
+    const int nbVertices = _graph.getNbVertices();
+    if (nbVertices == 0 || _vertexMasked[0]) return false;
+    const double unreached = -numeric_limits<double>::infinity();
+    vector<double> best(nbVertices, unreached);
+    vector<int> bestArc(nbVertices, -1);
+    best[0] = 0;
+
+    ///< successors are in later columns, so every vertex is final when its arcs are relaxed
+    for (int u = 0; u < nbVertices; u++) {
+        if (best[u] == unreached || _vertexMasked[u]) continue;
+        for (int a = _graph._arcOffsets[u]; a < _graph._arcOffsets[u + 1]; a++) {
+            const int v = _graph._arcSuccessors[a];
+            if (_arcMasked[a] || _vertexMasked[v]) continue;
+            if (best[u] + _arcWeights[a] > best[v]) {
+                best[v] = best[u] + _arcWeights[a];
+                bestArc[v] = a;
+            }
+        }
+    }
+
+    const int sink = nbVertices - 1;
+    if (best[sink] == unreached || _vertexMasked[sink]) return false;
+    vector<int> arcs;
+    for (int v = sink; v != 0; v = _arcSources[bestArc[v]])
+        arcs.push_back(bestArc[v]);
+    makePath(arcs, best[sink], path);
+    return true;
+}
+
+vector<PricingPath> TBPPricer::findBestPaths(int k) const {
+    TBP_PROFILE_SCOPE("pricing.bestPaths");
+    vector<PricingPath> paths;
+    const int nbVertices = _graph.getNbVertices();
+    if (k <= 0 || nbVertices == 0 || _vertexMasked[0]) return paths;
+
+    ///< arcs and parents of the kept labels of all vertices, to walk the paths back;
+    ///< weights are only needed for the column being extended
+    vector<int> labelArcs;
+    vector<int> labelParents;
+    vector<int> labelBegin(nbVertices + 1, 0);
+    vector<double> weights;
+    ///< up to k labels per vertex of a column, in a heap with the lightest on top
+    vector<PricingLabel> heaps(k, PricingLabel(0, -1, -1));
+    vector<int> heapSizes(1, 1);
+    vector<PricingLabel> nextHeaps;
+    vector<int> nextHeapSizes;
+
+    for (int c = 0; c < _graph.getNbColumns(); c++) {
+        const int first = _graph._columnOffsets[c];
+        const int last = _graph._columnOffsets[c + 1];
+        const int firstLabel = labelArcs.size();
+        weights.clear();
+        for (int u = first; u < last; u++) {
+            PricingLabel * heap = heaps.data() + (size_t)(u - first) * k;
+            sort(heap, heap + heapSizes[u - first]);
+            labelBegin[u] = labelArcs.size();
+            for (int l = 0; l < heapSizes[u - first]; l++) {
+                labelArcs.push_back(heap[l]._arc);
+                labelParents.push_back(heap[l]._parent);
+                weights.push_back(heap[l]._weight);
+            }
+        }
+        labelBegin[last] = labelArcs.size();
+        if (c + 1 == _graph.getNbColumns()) break;
+
+        const int nextFirst = last;
+        nextHeaps.resize((size_t)_graph.getColumnSize(c + 1) * k, PricingLabel(0, -1, -1));
+        nextHeapSizes.assign(_graph.getColumnSize(c + 1), 0);
+        for (int u = first; u < last; u++) {
+            if (_vertexMasked[u]) continue;
+            for (int a = _graph._arcOffsets[u]; a < _graph._arcOffsets[u + 1]; a++) {
+                const int v = _graph._arcSuccessors[a];
+                if (_arcMasked[a] || _vertexMasked[v]) continue;
+                PricingLabel * heap = nextHeaps.data() + (size_t)(v - nextFirst) * k;
+                int & size = nextHeapSizes[v - nextFirst];
+                for (int l = labelBegin[u]; l < labelBegin[u + 1]; l++) {
+                    const PricingLabel label(weights[l - firstLabel] + _arcWeights[a], a, l);
+                    if (size < k) {
+                        heap[size++] = label;
+                        push_heap(heap, heap + size);
+                    } else if (label < heap[0]) {
+                        pop_heap(heap, heap + size);
+                        heap[size - 1] = label;
+                        push_heap(heap, heap + size);
+                    } else
+                        break;    ///< the labels of u come heaviest first, the next ones are lighter still
+                }
+            }
+        }
+        heaps.swap(nextHeaps);
+        heapSizes.swap(nextHeapSizes);
+    }
+
+    const int sink = nbVertices - 1;
+    if (_vertexMasked[sink]) return paths;
+    for (int l = labelBegin[sink]; l < labelBegin[sink + 1]; l++) {
+        vector<int> arcs;
+        for (int m = l; labelParents[m] != -1; m = labelParents[m])
+            arcs.push_back(labelArcs[m]);
+        paths.push_back(PricingPath());
+        makePath(arcs, weights[l - labelBegin[sink]], paths.back());
+    }
+    return paths;
+}
@@ -0,0 +1,68 @@
+//
+// Created by lhirwashema on 2022-07-22.
+//
+
+#include "../include/TBPprofile.hpp"
+
+using namespace std;
+
+Profiler & Profiler::getInstance(){
+    static Profiler profiler;
+    return profiler;
+}
+
+ProfileEntry & Profiler::getEntry(const string & name){
+    lock_guard<mutex> lock(_mutex);
+    for (auto & entry : _entries)
+        if (entry._name == name) return entry;
+    _entries.emplace_back(name);
+    return _entries.back();
+}
+
+void Profiler::reset(){
+    lock_guard<mutex> lock(_mutex);
+    for (auto & entry : _entries) {
+        entry._nbCalls = 0;
+        entry._totalNs = 0;
+        entry._count = 0;
+    }
+}
+
+void Profiler::writeJson(ostream & out) const {
+    lock_guard<mutex> lock(_mutex);
+    out << "[";
+    for (size_t e = 0; e < _entries.size(); e++) {
+        const ProfileEntry & entry = _entries[e];
+        out << (e > 0 ? ",\n " : "\n ") << "{\"name\":\"" << entry._name << "\",\"calls\":" << entry._nbCalls
+            << ",\"ms\":" << entry._totalNs / 1e6 << ",\"count\":" << entry._count << "}";
+    }
+    out << "\n]\n";
+}
+
+void Profiler::writeCsv(ostream & out) const {
+    lock_guard<mutex> lock(_mutex);
+    out << "name,calls,ms,count\n";
+    for (const auto & entry : _entries)
+        out << entry._name << "," << entry._nbCalls << "," << entry._totalNs / 1e6 << "," << entry._count << "\n";
+}
+
+void writeColumnStatsJson(ostream & out, const vector<ColumnStats> & stats){
+    out << "[";
+    for (size_t c = 0; c < stats.size(); c++) {
+        const ColumnStats & s = stats[c];
+        out << (c > 0 ? ",\n " : "\n ") << "{\"clique\":" << c << ",\"width\":" << s._width
+            << ",\"combos\":" << s._nbCombos << ",\"checks\":" << s._nbChecks
+            << ",\"candidates\":" << s._nbCandidates << ",\"arcs\":" << s._nbArcs
+            << ",\"combos_ms\":" << s._combosMs << ",\"link_ms\":" << s._linkMs << ",\"bytes\":" << s._bytes << "}";
+    }
+    out << "\n]\n";
+}
+
+void writeColumnStatsCsv(ostream & out, const vector<ColumnStats> & stats){
+    out << "clique,width,combos,checks,candidates,arcs,combos_ms,link_ms,bytes\n";
+    for (size_t c = 0; c < stats.size(); c++) {
+        const ColumnStats & s = stats[c];
+        out << c << "," << s._width << "," << s._nbCombos << "," << s._nbChecks << "," << s._nbCandidates
+            << "," << s._nbArcs << "," << s._combosMs << "," << s._linkMs << "," << s._bytes << "\n";
+    }
+}
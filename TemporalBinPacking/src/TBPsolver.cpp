@@ -0,0 +1,450 @@
+//
+// Created by lhirwashema on 2022-07-15.
+//
+
+#include "../include/TBPsolver.hpp"
+#include "../include/TBPbounds.hpp"
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+TBPSolver::TBPSolver(const TemporalBPData & data) :
+    _maxNbStates(1000000),
+    _data(data)
+{
+    const LayeredGraph & graph = data._graph;
+    _columnItems.resize(graph.getNbColumns());
+    vector<int> seen(data.getNbItems(), -1);
+    for (int c = 0; c < graph.getNbColumns(); c++) {
+        for (int id = graph._columnOffsets[c]; id < graph._columnOffsets[c + 1]; id++) {
+            VertexView u = graph.getVertexById(id);
+            for (const int * it = u.itemsBegin(); it != u.itemsEnd(); it++) {
+                if (seen[*it] != c) {
+                    seen[*it] = c;
+                    _columnItems[c].push_back(*it);
+                }
+            }
+        }
+        sort(_columnItems[c].begin(), _columnItems[c].end());
+    }
+}
+
+TBPSolution TBPSolver::solve(){
+    return closeGap(solveGreedy(), computeLowerBound());
+}
+
+TBPSolution TBPSolver::solve(const TBPBounds & bounds){
+    TBPSolution solution = solveGreedy();
+    if ((int)bounds._firstFit._binOfItem.size() == _data.getNbItems() && bounds.getUpperBound() < solution._nbBins)
+        solution = bounds._firstFit;
+    return closeGap(solution, max(computeLowerBound(), bounds._lowerBound));
+}
+
+TBPSolution TBPSolver::closeGap(TBPSolution solution, int lowerBound){
+    solution._lowerBound = lowerBound;
+    if (solution._nbBins == solution._lowerBound)
+        solution._optimal = true;
+    else if (solution._nbBins > solution._lowerBound)
+        solution._optimal = improve(solution);
+    ///< fewer bins than a proven bound: the paths of a relaxation (reduced graph), which proves nothing
+    if (solution._nbBins < solution._lowerBound)
+        solution._optimal = false;
+    if (solution._optimal)
+        solution._lowerBound = max(solution._lowerBound, solution._nbBins);
+    return solution;
+}
+
+int TBPSolver::computeLowerBound() const {
+    int lowerBound = 0;
+    if (_data.getCapacity() <= 0) return lowerBound;
+    for (const auto & items : _columnItems) {
+        long total = 0;
+        for (const auto & item : items)
+            total += _data._items[item]._size;
+        lowerBound = max<long>(lowerBound, (total + _data.getCapacity() - 1) / _data.getCapacity());
+    }
+    return lowerBound;
+}
+
+TBPSolution TBPSolver::solveGreedy() const {
+    TBP_PROFILE_SCOPE("solver.greedy");
+    const LayeredGraph & graph = _data._graph;
+    const int nbItems = _data.getNbItems();
+    const int nbVertices = graph.getNbVertices();
+    const int nbArcs = graph.getNbArcs();
+    TBPSolution solution;
+    solution._binOfItem.assign(nbItems, -1);
+    if (nbItems == 0 || nbVertices < 2) return solution;
+
+    ///< an uncovered item weighs its size first and counts for one as a tie-breaker
+    vector<long> itemWeight(nbItems);
+    for (int i = 0; i < nbItems; i++)
+        itemWeight[i] = (long)_data._items[i]._size * (nbItems + 1) + 1;
+
+    ///< weight of each arc in the uncovered items, and the arcs of each item to update it
+    vector<long> arcWeight(nbArcs, 0);
+    vector<int> itemArcOffsets(nbItems + 1, 0);
+    for (const auto & item : graph._arcItems)
+        itemArcOffsets[item + 1]++;
+    for (int i = 0; i < nbItems; i++)
+        itemArcOffsets[i + 1] += itemArcOffsets[i];
+    vector<int> itemArcs(itemArcOffsets[nbItems]);
+    vector<int> fill(itemArcOffsets.begin(), itemArcOffsets.end() - 1);
+    for (int a = 0; a < nbArcs; a++) {
+        for (int k = graph._arcItemOffsets[a]; k < graph._arcItemOffsets[a + 1]; k++) {
+            const int & item = graph._arcItems[k];
+            arcWeight[a] += itemWeight[item];
+            itemArcs[fill[item]++] = a;
+        }
+    }
+
+    ///< heaviest path ending at each vertex, vertices being numbered chronologically
+    vector<long> best(nbVertices);
+    vector<int> predArc(nbVertices);
+    vector<int> predVertex(nbVertices);
+    const int sink = nbVertices - 1;
+    int nbCovered = 0;
+    while (nbCovered < nbItems) {
+        std::fill(best.begin(), best.end(), -1);
+        best[0] = 0;
+        for (int u = 0; u < nbVertices; u++) {
+            if (best[u] < 0) continue;
+            for (int a = graph._arcOffsets[u]; a < graph._arcOffsets[u + 1]; a++) {
+                const int & v = graph._arcSuccessors[a];
+                if (best[u] + arcWeight[a] > best[v]) {
+                    best[v] = best[u] + arcWeight[a];
+                    predArc[v] = a;
+                    predVertex[v] = u;
+                }
+            }
+        }
+        if (best[sink] <= 0) break;     ///< the remaining items are in no path
+
+        const int bin = solution._nbBins++;
+        for (int v = sink; v != 0; v = predVertex[v]) {
+            const int & a = predArc[v];
+            for (int k = graph._arcItemOffsets[a]; k < graph._arcItemOffsets[a + 1]; k++) {
+                const int & item = graph._arcItems[k];
+                if (solution._binOfItem[item] != -1) continue;
+                solution._binOfItem[item] = bin;
+                nbCovered++;
+                for (int e = itemArcOffsets[item]; e < itemArcOffsets[item + 1]; e++)
+                    arcWeight[itemArcs[e]] -= itemWeight[item];
+            }
+        }
+    }
+    return solution;
+}
+
+/**
+ * Items of a graph column with their positions as bits of a 64-bit mask
+ */
+class DPColumn {
+public:
+    vector<int> _items;                  ///< items of the column, bit p stands for _items[p]
+    vector<int> _sizes;
+    uint64_t _carriedIn;                 ///< items already in the previous column
+    uint64_t _carriedOut;                ///< items still in the next column
+    vector<int> _toNext;                 ///< position of a carried item in the next column
+    unordered_set<uint64_t> _vertices;   ///< item sets of the vertices of the column
+    ///< graph with dominance pruning: local items of the vertices, by items shared with the neighbouring columns
+    unordered_map<uint64_t, vector<uint64_t>> _localParts;
+
+    /**
+     * Determines whether a bin can hold exactly these items of the column: they form a vertex, or, once dominated
+     * vertices are pruned, they are a vertex without some of its local items
+     */
+    bool isBlock(uint64_t block) const {
+        if (_vertices.count(block)) return true;
+        if (_localParts.empty()) return false;
+        const uint64_t shared = _carriedIn | _carriedOut;
+        auto found = _localParts.find(block & shared);
+        if (found == _localParts.end()) return false;
+        for (const auto & local : found->second)
+            if ((block & ~shared & ~local) == 0) return true;
+        return false;
+    }
+};
+
+/**
+ * States of the dynamic program between two columns.
+ * A state splits the items carried into the next column into groups, one per bin, given as sorted masks
+ * over the next column. Blocks are the item sets chosen for the bins in the column leading to the state.
+ */
+class DPLayer {
+public:
+    vector<int> _groupOffsets;       ///< groups of state s are _groups[_groupOffsets[s]] ... _groups[_groupOffsets[s+1]-1]
+    vector<uint64_t> _groups;
+    vector<int> _cost;               ///< largest number of bins used so far
+    vector<int> _parent;             ///< state of the previous layer
+    vector<int> _blockBegin;         ///< blocks leading to state s are _blocks[_blockBegin[s]] ... _blocks[_blockEnd[s]-1]
+    vector<int> _blockEnd;
+    vector<uint64_t> _blocks;
+
+    DPLayer() : _groupOffsets(1, 0) {}
+
+    int size() const { return _cost.size(); }
+};
+
+class MaskVectorHash {
+public:
+    size_t operator()(const vector<uint64_t> & masks) const {
+        uint64_t h = 1469598103934665603ULL;
+        for (const auto & m : masks)
+            h = (h ^ m) * 1099511628211ULL + (h >> 29);
+        return h;
+    }
+};
+
+/**
+ * Enumerates the partitions of the items of a column into blocks that extend the groups of a state,
+ * each new item joining a group, an already opened block or a new one
+ */
+class ColumnPartitioner {
+public:
+    const DPColumn & _column;
+    const int _capacity;
+    const int _maxNbBlocks;
+    vector<int> _newPositions;
+    vector<uint64_t> _blocks;
+    vector<int> _sums;
+    function<void(const vector<uint64_t> &)> _onPartition;
+
+    ColumnPartitioner(const DPColumn & column, int capacity, int maxNbBlocks) :
+        _column(column),
+        _capacity(capacity),
+        _maxNbBlocks(maxNbBlocks)
+    {
+        for (int p = 0; p < (int)column._items.size(); p++)
+            if (!((column._carriedIn >> p) & 1))
+                _newPositions.push_back(p);
+    }
+
+    void run(const uint64_t * groupsBegin, const uint64_t * groupsEnd){
+        _blocks.assign(groupsBegin, groupsEnd);
+        _sums.clear();
+        for (const auto & group : _blocks) {
+            int sum = 0;
+            for (int p = 0; p < (int)_column._items.size(); p++)
+                if ((group >> p) & 1) sum += _column._sizes[p];
+            _sums.push_back(sum);
+        }
+        if ((int)_blocks.size() <= _maxNbBlocks)
+            place(0);
+    }
+
+private:
+    void place(int k){
+        if (k == (int)_newPositions.size()) {
+            for (const auto & block : _blocks)
+                if (!_column.isBlock(block)) return;
+            _onPartition(_blocks);
+            return;
+        }
+        const int & p = _newPositions[k];
+        const int & size = _column._sizes[p];
+        for (int j = 0; j < (int)_blocks.size(); j++) {
+            if (_sums[j] + size > _capacity) continue;
+            _blocks[j] |= uint64_t(1) << p;
+            _sums[j] += size;
+            place(k + 1);
+            _blocks[j] &= ~(uint64_t(1) << p);
+            _sums[j] -= size;
+        }
+        if ((int)_blocks.size() < _maxNbBlocks) {
+            _blocks.push_back(uint64_t(1) << p);
+            _sums.push_back(size);
+            place(k + 1);
+            _blocks.pop_back();
+            _sums.pop_back();
+        }
+    }
+};
+
+bool TBPSolver::improve(TBPSolution & solution) const {
+    TBP_PROFILE_SCOPE("solver.improve");
+    const LayeredGraph & graph = _data._graph;
+    const int nbColumns = graph.getNbColumns();
+    const int nbItems = _data.getNbItems();
+    if (nbColumns < 3) return true;
+
+    ///< columns 1 ... nbColumns-2 hold the cliques, the start and the sink have no items
+    vector<DPColumn> columns(nbColumns);
+    vector<int> position(nbItems, -1);
+    for (int c = 1; c < nbColumns - 1; c++) {
+        if (_columnItems[c].size() > 64) return false;
+    }
+    for (int c = 1; c < nbColumns - 1; c++) {
+        DPColumn & column = columns[c];
+        column._items = _columnItems[c];
+        for (const auto & item : column._items)
+            column._sizes.push_back(_data._items[item]._size);
+        for (int id = graph._columnOffsets[c]; id < graph._columnOffsets[c + 1]; id++) {
+            VertexView u = graph.getVertexById(id);
+            uint64_t mask = 0;
+            for (const int * it = u.itemsBegin(); it != u.itemsEnd(); it++)
+                mask |= uint64_t(1) << (lower_bound(column._items.begin(), column._items.end(), *it) - column._items.begin());
+            column._vertices.insert(mask);
+        }
+    }
+    for (int c = 1; c < nbColumns - 1; c++) {
+        DPColumn & column = columns[c];
+        column._carriedIn = 0;
+        column._carriedOut = 0;
+        column._toNext.assign(column._items.size(), -1);
+        for (int p = 0; p < (int)_columnItems[c + 1].size(); p++)
+            position[_columnItems[c + 1][p]] = p;
+        for (int p = 0; p < (int)column._items.size(); p++) {
+            if (position[column._items[p]] != -1) {
+                column._carriedOut |= uint64_t(1) << p;
+                column._toNext[p] = position[column._items[p]];
+            }
+        }
+        for (const auto & item : _columnItems[c + 1])
+            position[item] = -1;
+        for (const auto & item : _columnItems[c - 1])
+            position[item] = 1;
+        for (int p = 0; p < (int)column._items.size(); p++)
+            if (position[column._items[p]] != -1)
+                column._carriedIn |= uint64_t(1) << p;
+        for (const auto & item : _columnItems[c - 1])
+            position[item] = -1;
+
+        if (_data._buildOptions._dominancePruning) {
+            const uint64_t shared = column._carriedIn | column._carriedOut;
+            for (const auto & vertex : column._vertices)
+                column._localParts[vertex & shared].push_back(vertex & ~shared);
+        }
+    }
+
+    ///< layers[b] holds the states entering column b+1, the first one starts with no bin in use
+    const int maxNbBins = solution._nbBins - 1;      ///< only strictly better solutions are searched
+    vector<DPLayer> layers(nbColumns - 1);
+    layers[0]._cost.push_back(0);
+    layers[0]._parent.push_back(-1);
+    layers[0]._groupOffsets.push_back(0);
+    layers[0]._blockBegin.push_back(0);
+    layers[0]._blockEnd.push_back(0);
+    long nbStates = 1;
+    bool overBudget = false;
+
+    for (int c = 1; c < nbColumns - 1 && !overBudget; c++) {
+        const DPLayer & current = layers[c - 1];
+        DPLayer & next = layers[c];
+        const DPColumn & column = columns[c];
+        unordered_map<vector<uint64_t>, int, MaskVectorHash> index;
+        ColumnPartitioner partitioner(column, _data.getCapacity(), maxNbBins);
+        vector<uint64_t> groups;
+        int s;
+
+        partitioner._onPartition = [&](const vector<uint64_t> & blocks){
+            const int cost = max<int>(current._cost[s], blocks.size());
+            groups.clear();
+            for (const auto & block : blocks) {
+                uint64_t carried = block & column._carriedOut;
+                if (!carried) continue;
+                uint64_t group = 0;
+                for (; carried; carried &= carried - 1)
+                    group |= uint64_t(1) << column._toNext[__builtin_ctzll(carried)];
+                groups.push_back(group);
+            }
+            sort(groups.begin(), groups.end());
+
+            auto found = index.find(groups);
+            int t;
+            if (found == index.end()) {
+                t = next.size();
+                index[groups] = t;
+                next._groups.insert(next._groups.end(), groups.begin(), groups.end());
+                next._groupOffsets.push_back(next._groups.size());
+                next._cost.push_back(cost);
+                next._parent.push_back(-1);
+                next._blockBegin.push_back(0);
+                next._blockEnd.push_back(0);
+                if (++nbStates > _maxNbStates) overBudget = true;
+            } else {
+                t = found->second;
+                if (cost >= next._cost[t]) return;
+                next._cost[t] = cost;
+            }
+            next._parent[t] = s;
+            next._blockBegin[t] = next._blocks.size();
+            next._blocks.insert(next._blocks.end(), blocks.begin(), blocks.end());
+            next._blockEnd[t] = next._blocks.size();
+        };
+
+        for (s = 0; s < current.size() && !overBudget; s++) {
+            partitioner.run(current._groups.data() + current._groupOffsets[s],
+                            current._groups.data() + current._groupOffsets[s + 1]);
+        }
+    }
+    if (overBudget) return false;
+
+    const DPLayer & lastLayer = layers[nbColumns - 2];
+    if (lastLayer.size() == 0) return true;     ///< no solution with fewer bins than the current one
+    const int nbBins = lastLayer._cost[0];
+
+    ///< blocks of every column, from the last one back to the first one
+    vector<vector<uint64_t>> blocks(nbColumns);
+    for (int c = nbColumns - 2, s = 0; c >= 1; c--) {
+        const DPLayer & layer = layers[c];
+        blocks[c].assign(layer._blocks.begin() + layer._blockBegin[s], layer._blocks.begin() + layer._blockEnd[s]);
+        s = layer._parent[s];
+    }
+
+    ///< bins follow their carried items, new blocks take the lowest bins left free in the column
+    solution._binOfItem.assign(nbItems, -1);
+    solution._nbBins = 0;
+    for (int c = 1; c < nbColumns - 1; c++) {
+        const DPColumn & column = columns[c];
+        vector<int> binOfBlock(blocks[c].size(), -1);
+        vector<char> used(nbBins, 0);
+        for (int j = 0; j < (int)blocks[c].size(); j++) {
+            uint64_t carried = blocks[c][j] & column._carriedIn;
+            if (carried) {
+                binOfBlock[j] = solution._binOfItem[column._items[__builtin_ctzll(carried)]];
+                used[binOfBlock[j]] = 1;
+            }
+        }
+        for (int j = 0, free = 0; j < (int)blocks[c].size(); j++) {
+            if (binOfBlock[j] != -1) continue;
+            while (used[free]) free++;
+            binOfBlock[j] = free;
+            used[free] = 1;
+        }
+        for (int j = 0; j < (int)blocks[c].size(); j++) {
+            for (uint64_t mask = blocks[c][j]; mask; mask &= mask - 1) {
+                int & bin = solution._binOfItem[column._items[__builtin_ctzll(mask)]];
+                if (bin == -1) bin = binOfBlock[j];
+            }
+            solution._nbBins = max(solution._nbBins, binOfBlock[j] + 1);
+        }
+    }
+    return true;
+}
+
+bool isValidSolution(TemporalBPData & data, const TBPSolution & solution){
+    if ((int)solution._binOfItem.size() != data.getNbItems()) return false;
+    vector<vector<int>> bins(solution._nbBins);
+    for (int i = 0; i < data.getNbItems(); i++) {
+        const int & bin = solution._binOfItem[i];
+        if (bin < 0 || bin >= solution._nbBins) return false;
+        bins[bin].push_back(i);
+    }
+    for (auto & bin : bins)
+        if (!data.isFeasible(bin)) return false;
+    return true;
+}
+
+TBPSolution checkRelaxedSolution(TemporalBPData & data, const TBPSolution & solution, const TBPSolution & firstFit){
+    if (isValidSolution(data, solution)) return solution;
+    TBPSolution checked = firstFit._binOfItem.empty() ? computeBounds(data)._firstFit : firstFit;
+    checked._lowerBound = max(checked._lowerBound, solution._optimal ? solution._nbBins : solution._lowerBound);
+    checked._optimal = checked._nbBins <= checked._lowerBound;
+    if (checked._optimal)
+        checked._lowerBound = checked._nbBins;
+    return checked;
+}
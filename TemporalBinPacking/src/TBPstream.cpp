@@ -0,0 +1,183 @@
+//
+// Created by lhirwashema on 2022-07-18.
+//
+
+#include "../include/TBPstream.hpp"
+#include "../include/TBPlinker.hpp"
+#include <algorithm>
+
+using namespace std;
+
+StreamingGraphBuilder::StreamingGraphBuilder(int capacity, bool reduced, const ColumnCallback & onColumn) :
+    _capacity(capacity),
+    _reduced(reduced),
+    _onColumn(onColumn),
+    _nbItems(0),
+    _lastEntry(0),
+    _nbColumns(0),
+    _maxNbCombosClique(0),
+    _finished(false),
+    _nbRawCliques(0),
+    _hasPending(false){}
+
+int StreamingGraphBuilder::addItem(int size, int entry, int exit){
+    if (_nbItems > 0 && entry < _lastEntry)
+        return -1;
+    _lastEntry = entry;
+    if (!_exits.empty() && _exits.top().first <= entry)
+        closeClique();   ///< an ongoing item leaves before the new one enters
+
+    const int id = _nbItems++;
+    _live.emplace(id, Item(id, size, entry, exit));
+    _ongoing.push_back(id);
+    _exits.push(make_pair(exit, id));
+    return id;
+}
+
+/**
+ * Hands the ongoing items over as a clique, then removes the items that left before the last entry
+ */
+void StreamingGraphBuilder::closeClique(){
+    onRawClique(_ongoing);
+
+    vector<int> left;
+    while (!_exits.empty() && _exits.top().first <= _lastEntry) {
+        left.push_back(_exits.top().second);
+        _exits.pop();
+    }
+    sort(left.begin(), left.end());
+    int kept = 0;
+    for (const auto & j : _ongoing)
+        if (!binary_search(left.begin(), left.end(), j)) _ongoing[kept++] = j;
+    _ongoing.resize(kept);
+
+    collectGarbage();
+}
+
+/**
+ * In reduced mode, clique a loses the items of reduced clique a-1 that are not in clique a+1,
+ * as in TemporalBPData::getReducedCliques, so it is released once clique a+1 arrives
+ */
+void StreamingGraphBuilder::onRawClique(const vector<int> & clique){
+    const int a = _nbRawCliques++;
+    if (!_reduced || a == 0) {
+        if (_reduced) _previousReduced = clique;
+        onClique(clique);
+        return;
+    }
+    if (a >= 2) {
+        vector<int> reduced;
+        for (const auto & item : _pendingRaw)
+            if (!binary_search(_previousReduced.begin(), _previousReduced.end(), item)
+             || binary_search(clique.begin(), clique.end(), item))
+                reduced.push_back(item);
+        _previousReduced = reduced;
+        onClique(reduced);
+    }
+    _pendingRaw = clique;
+}
+
+/**
+ * Enumerates the combinations of a clique and emits the column of the previous one, now that its successors are known
+ */
+void StreamingGraphBuilder::onClique(const vector<int> & clique){
+    vector<const Item *> cliqueItems;
+    for (const auto & itemId : clique)
+        cliqueItems.push_back(&_live.find(itemId)->second);
+    FeasibleCombos combos = ComboEnumerator(cliqueItems, _capacity).enumerate();
+    _maxNbCombosClique = max(_maxNbCombosClique, combos.size());
+
+    GraphColumn column;
+    if (!_hasPending) {   ///< the start vertex connects to every vertex of the first clique
+        for (int v=0; v<combos.size(); v++) {
+            combos.appendItems(v, column._arcItems);
+            column.closeArc(v);
+        }
+        column.closeVertex();
+    } else {
+        for (int c=0; c<_pending.size(); c++) {
+            _pending.appendItems(c, column._items);
+            column._itemOffsets.push_back(column._items.size());
+        }
+        linkIndexed(_pending, combos, column);
+    }
+    emit(column);
+
+    _pending = combos;
+    _hasPending = true;
+}
+
+void StreamingGraphBuilder::finish(){
+    if (_finished)
+        return;
+    _finished = true;
+
+    ///< the final items present since the last entry also form a clique
+    onRawClique(_ongoing);
+    if (_reduced && _nbRawCliques >= 2) {   ///< the last clique loses every item of the previous one
+        vector<int> reduced;
+        for (const auto & item : _pendingRaw)
+            if (!binary_search(_previousReduced.begin(), _previousReduced.end(), item))
+                reduced.push_back(item);
+        onClique(reduced);
+    }
+
+    GraphColumn last;   ///< any vertex of the last clique connects to the sink
+    for (int c=0; c<_pending.size(); c++) {
+        _pending.appendItems(c, last._items);
+        last.closeArc(0);
+        last.closeVertex();
+    }
+    emit(last);
+
+    GraphColumn sink;
+    sink.closeVertex();
+    emit(sink);
+
+    _pending = FeasibleCombos();
+    _pendingRaw.clear();
+    _previousReduced.clear();
+    _ongoing.clear();
+    _live.clear();
+}
+
+void StreamingGraphBuilder::emit(const GraphColumn & column){
+    _nbColumns++;
+    _onColumn(column);
+}
+
+/**
+ * Forgets the items that left and that no clique of the window still has to enumerate
+ */
+void StreamingGraphBuilder::collectGarbage(){
+    for (auto it = _live.begin(); it != _live.end(); ) {
+        const int & id = it->first;
+        if (binary_search(_ongoing.begin(), _ongoing.end(), id)
+         || binary_search(_pendingRaw.begin(), _pendingRaw.end(), id))
+            ++it;
+        else
+            it = _live.erase(it);
+    }
+}
+
+bool streamGraph(istream & in, bool reduced, const StreamingGraphBuilder::ColumnCallback & onColumn){
+    int nbItems;
+    int capacity;
+    int unused;
+    if (!(in >> nbItems >> capacity >> unused >> unused))
+        return false;
+
+    StreamingGraphBuilder builder(capacity, reduced, onColumn);
+    int id;
+    int entry;
+    int exit;
+    int size;
+    for (int i = 0; i < nbItems; i++) {
+        if (!(in >> id >> entry >> exit >> size))
+            return false;
+        if (builder.addItem(size, entry, exit) < 0)
+            return false;
+    }
+    builder.finish();
+    return true;
+}